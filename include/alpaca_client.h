@@ -1,12 +1,20 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 #include <map>
 
+// Timestamps in market data are epoch nanoseconds (UTC), parsed once from the
+// API's ISO 8601 text as responses are decoded (see timestamps.h); 0 = unknown
+
 struct Quote {
     std::string symbol;
     double bid_price{};
@@ -14,7 +22,7 @@ struct Quote {
     double last_price{};
     long bid_size{};
     long ask_size{};
-    std::string timestamp; // ISO 8601 (lexicographically comparable)
+    std::int64_t timestamp{}; // Epoch ns
 };
 
 struct Snapshot {
@@ -23,7 +31,7 @@ struct Snapshot {
     double latest_quote_bid{};
     double latest_quote_ask{};
     double prev_daily_bar_close{};
-    std::string latest_trade_timestamp; // ISO 8601 (lexicographically comparable)
+    std::int64_t latest_trade_timestamp{}; // Epoch ns
     long minute_bar_volume{};           // Volume from current minute bar
 
     // Market quality metrics (calculated from bid/ask)
@@ -31,14 +39,23 @@ struct Snapshot {
     bool tradeable{true}; // Whether spread/volume are acceptable
 };
 
+// Plain 48-byte record, so bar vectors copy, store and map as raw memory
 struct Bar {
-    std::string timestamp; // ISO 8601 (lexicographically comparable)
+    std::int64_t timestamp{}; // Epoch ns of the bar's start
     double open{};
     double high{};
     double low{};
     double close{};
     long volume{};
 };
+static_assert(std::is_trivially_copyable_v<Bar> and sizeof(Bar) <= 48,
+              "Bars are compact trivially copyable records");
+
+// One page of a paged bars response
+struct BarPage {
+    std::vector<Bar> bars;
+    std::string next_page_token; // Empty on the last page
+};
 
 struct Position {
     std::string symbol;
@@ -56,6 +73,20 @@ struct MarketClock {
     std::string next_close;  // ISO timestamp of next market close
 };
 
+// Request/connection counters for one API host
+struct ConnectionStats {
+    std::uint64_t requests{};   // Requests sent (including reconnect retries)
+    std::uint64_t handshakes{}; // Requests that had to open a new TCP/TLS connection
+    std::uint64_t reused{};     // Requests served on an already-open keep-alive socket
+    std::uint64_t reconnects{}; // Requests retried after a stale socket failed
+    std::uint64_t throttled{};    // Requests held back by the rate limiter
+    std::uint64_t rate_limited{}; // 429 responses (retried after backing off)
+};
+
+class ConnectionPool;
+class RateLimiter;
+class ThreadPool;
+
 enum class AlpacaError {
     NetworkError,
     AuthError,
@@ -65,14 +96,36 @@ enum class AlpacaError {
     UnknownError
 };
 
+// One page of a multi-symbol bars response
+struct MultiBarPage {
+    std::map<std::string, std::vector<Bar>> bars;
+    std::string next_page_token; // Empty on the last page
+};
+
+// Response body parsers (used by AlpacaClient; free for benchmarks)
+// Streaming (SAX) decoders that write straight into the result without
+// building a JSON document first (see alpaca_json.cxx)
+// Single-symbol endpoint: {"bars": [...], "next_page_token": ...}
+std::expected<BarPage, AlpacaError> parse_bars_page(std::string_view);
+// Multi-symbol endpoint: {"bars": {"AAPL": [...], ...}, "next_page_token": ...}
+// (crypto bars share this layout)
+std::expected<MultiBarPage, AlpacaError> parse_multi_bars_page(std::string_view);
+// Stock snapshots: {"AAPL": {"latestTrade": ..., ...}, ...}
+std::expected<std::map<std::string, Snapshot>, AlpacaError>
+parse_snapshots(std::string_view);
+// Crypto snapshots: {"snapshots": {"BTC/USD": {...}, ...}}
+std::expected<std::map<std::string, Snapshot>, AlpacaError>
+parse_crypto_snapshots(std::string_view);
+
 class AlpacaClient {
 public:
     AlpacaClient();
+    ~AlpacaClient();
 
     // Check if client has valid credentials
     bool is_valid() const { return not api_key_.empty() and not api_secret_.empty(); }
 
-    // Get latest quotes for stock symbols
+    // Get latest quotes for stock symbols (any number, fetched in chunks)
     std::expected<std::map<std::string, Snapshot>, AlpacaError>
     get_snapshots(const std::vector<std::string>&);
 
@@ -104,18 +157,58 @@ public:
     // Close a position by symbol
     std::expected<std::string, AlpacaError> close_position(std::string_view);
 
+    // Get a single page of historic bars (empty token for the first page)
+    std::expected<BarPage, AlpacaError> get_bars_page(std::string_view, std::string_view, std::string_view, std::string_view, std::string_view, std::size_t = 10000);
+
     // Get historic bars (timeframe: "1Min", "1Hour", "1Day", etc.) with start/end dates
+    // Follows every page; use BarPageReader to process long ranges page by page
     std::expected<std::vector<Bar>, AlpacaError> get_bars(std::string_view, std::string_view, std::string_view, std::string_view);
 
     // Get historic bars for last N days (convenience wrapper)
     std::optional<std::vector<Bar>> get_bars(std::string_view, std::string_view, int);
 
-    // Get historic crypto bars
+    // Get historic bars for many symbols via the multi-symbol endpoint
+    // (chunked by symbol count and following next_page_token)
+    std::expected<std::map<std::string, std::vector<Bar>>, AlpacaError>
+    get_multi_bars(const std::vector<std::string>&, std::string_view, std::string_view, std::string_view);
+
+    // Get multi-symbol historic bars for last N days (convenience wrapper)
+    std::optional<std::map<std::string, std::vector<Bar>>>
+    get_multi_bars(const std::vector<std::string>&, std::string_view, int);
+
+    // Get historic crypto bars (following next_page_token)
     std::expected<std::vector<Bar>, AlpacaError> get_crypto_bars(std::string_view, std::string_view, std::string_view, std::string_view);
 
     // Get market clock (returns full clock data including next open/close times)
     std::expected<MarketClock, AlpacaError> get_market_clock();
 
+    // Run request(i) for i in [0, count) concurrently and return the results
+    // in index order, e.g. one call per watchlist symbol:
+    //
+    //   auto bars = client.fan_out(symbols.size(), [&](std::size_t i) {
+    //       return client.get_bars(symbols[i], "1Min", 1);
+    //   });
+    //
+    // At most max_concurrent_requests() are in flight at once, and each still
+    // draws from the rate limiter, so a burst runs as fast as the quota
+    // allows. The calling thread takes a share of the work, so requests may
+    // themselves fan out
+    template <typename Request>
+    auto fan_out(std::size_t count, Request &&request)
+        -> std::vector<std::invoke_result_t<Request &, std::size_t>> {
+        auto results =
+            std::vector<std::invoke_result_t<Request &, std::size_t>>(count);
+        run_concurrent(count,
+                       [&](std::size_t i) { results[i] = request(i); });
+        return results;
+    }
+
+    std::size_t max_concurrent_requests() const;
+
+    // Keep-alive connection counters for the trading and market data hosts
+    ConnectionStats trading_connection_stats() const;
+    ConnectionStats data_connection_stats() const;
+
 private:
     std::string api_key_;
     std::string api_secret_;
@@ -124,5 +217,75 @@ private:
     std::string data_api_key_;
     std::string data_api_secret_;
 
+    // Request budget per host (trading and market data quotas are separate,
+    // and each host reports only its own)
+    std::unique_ptr<RateLimiter> trading_limiter_;
+    std::unique_ptr<RateLimiter> data_limiter_;
+
+    // Long-lived keep-alive connections, shared by every request
+    std::unique_ptr<ConnectionPool> trading_pool_;
+    std::unique_ptr<ConnectionPool> data_pool_;
+
+    // Workers for fan_out (the caller makes one more)
+    std::unique_ptr<ThreadPool> request_pool_;
+
+    void run_concurrent(std::size_t, const std::function<void(std::size_t)> &);
+
+    // Read every page of a multi-symbol bars request (path without
+    // page_token), appending each symbol's bars
+    std::expected<void, AlpacaError>
+    read_multi_bars_pages(std::string_view, std::map<std::string, std::vector<Bar>>&);
+
     std::string get_env_or_default(std::string_view, std::string_view);
 };
+
+// Streams historic bars for one symbol a page at a time, following
+// next_page_token, so long lookbacks can be consumed in bounded memory:
+//
+//   auto reader = BarPageReader{client, "SPY", "1Min", start, end};
+//   for (const auto &page : reader)
+//       process(page);
+//   if (reader.error()) ...
+class BarPageReader {
+public:
+    BarPageReader(AlpacaClient&, std::string_view, std::string_view, std::string_view, std::string_view, std::size_t = 10000);
+
+    // Fetch the next page (empty once every page has been read)
+    std::expected<std::vector<Bar>, AlpacaError> next();
+
+    bool done() const { return done_; }
+    std::optional<AlpacaError> error() const { return error_; }
+
+    // Input iterator over pages for range-for
+    class iterator {
+    public:
+        using value_type = std::vector<Bar>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(BarPageReader *reader) : reader_{reader} {}
+
+        const std::vector<Bar> &operator*() const { return page_; }
+        iterator &operator++();
+        void operator++(int) { ++*this; }
+        bool operator==(const iterator &other) const { return reader_ == other.reader_; }
+
+    private:
+        BarPageReader *reader_{};
+        std::vector<Bar> page_;
+    };
+
+    iterator begin();
+    iterator end() { return {}; }
+
+private:
+    AlpacaClient &client_;
+    std::string symbol_;
+    std::string timeframe_;
+    std::string start_;
+    std::string end_;
+    std::size_t page_size_;
+    std::string page_token_;
+    bool done_{false};
+    std::optional<AlpacaError> error_;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include "defs.h"
+#include "strategies.h"
+#include <array>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Exit thresholds applied to every backtest position (fractions, 0.01 = 1%)
+struct ExitParams {
+  double take_profit_pct{::take_profit_pct};
+  double stop_loss_pct{::stop_loss_pct};
+  double trailing_stop_pct{::trailing_stop_pct};
+  double panic_stop_loss_pct{::panic_stop_loss_pct};
+};
+
+// Stats for every strategy under one ExitParams, indexed by StrategyId
+using BacktestResult = std::array<StrategyStats, strategy_count>;
+
+// Single-sweep backtest of several strategies over the same bar history
+// Every symbol advances through time once; price histories and strategy
+// state are updated once per bar and shared by all strategies, and each
+// strategy trades its own position book and cash under the live exit
+// thresholds from defs.h. Symbols, then books, are processed concurrently on
+// the pool, each over the whole history with one wait per pass
+// Returns stats indexed by StrategyId (empty for strategies not in the mask)
+BacktestResult run_backtest(StrategyMask,
+                            const std::map<std::string, std::vector<Bar>> &,
+                            double, ThreadPool &);
+
+// As above, once per ExitParams in the same sweep over the bars
+// Entry signals depend only on the bars, so they are computed once per bar
+// and shared; only the (exit params x strategy) position books multiply
+// Returns one result per ExitParams, in the same order
+std::vector<BacktestResult>
+run_backtest(StrategyMask, std::span<const ExitParams>,
+             const std::map<std::string, std::vector<Bar>> &, double,
+             ThreadPool &);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+// CSV bar files, one per symbol: backtest_bars_<SYMBOL>.csv with the header
+// timestamp,open,high,low,close,volume (a conversion format for offline
+// analysis; the bar cache itself is binary, see bar_store.h)
+
+// Bars from one CSV file (empty if missing; malformed rows are skipped)
+std::vector<Bar> read_bars_csv(const std::filesystem::path &);
+
+// Every backtest_bars_*.csv in a directory, keyed by symbol
+std::map<std::string, std::vector<Bar>>
+read_bars_csv_dir(const std::filesystem::path &);
+
+// Write each symbol's bars to DIR/backtest_bars_<SYMBOL>.csv, creating DIR
+// (lft_backtest --export-csv)
+void write_bars_csv_dir(const std::filesystem::path &,
+                        const std::map<std::string, std::vector<Bar>> &);
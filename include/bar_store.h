@@ -0,0 +1,109 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// On-disk bar cache: one binary file per symbol/timeframe series
+//
+// File layout (native little-endian, memory-mappable):
+//   BarFileHeader (64 bytes)
+//   int64  timestamp[count]  (epoch ns)
+//   double open[count]
+//   double high[count]
+//   double low[count]
+//   double close[count]
+//   int64  volume[count]
+struct BarFileHeader {
+  char magic[8];                // "LFTBARS" + NUL
+  std::uint32_t version;
+  std::uint32_t header_size;
+  std::uint64_t count;
+  std::int64_t first_timestamp; // Epoch ns of first bar
+  std::int64_t last_timestamp;  // Epoch ns of last bar
+  std::uint64_t reserved[3];
+};
+
+static_assert(sizeof(BarFileHeader) == 64, "Bar file header is 64 bytes");
+
+constexpr auto bar_file_version = 1u;
+constexpr auto bar_file_columns = 6uz;
+
+// Read-only, zero-copy view of one bar file
+// Columns are spans straight into the memory mapping, valid while the view
+// lives; nothing is parsed or copied until bars are materialised
+class MappedBars {
+public:
+  MappedBars() = default;
+
+  // Map a bar file (empty if missing or corrupt)
+  explicit MappedBars(const std::filesystem::path &);
+  ~MappedBars();
+
+  MappedBars(MappedBars &&) noexcept;
+  MappedBars &operator=(MappedBars &&) noexcept;
+
+  std::size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  std::span<const std::int64_t> timestamps() const { return column<std::int64_t>(0); }
+  std::span<const double> opens() const { return column<double>(1); }
+  std::span<const double> highs() const { return column<double>(2); }
+  std::span<const double> lows() const { return column<double>(3); }
+  std::span<const double> closes() const { return column<double>(4); }
+  std::span<const std::int64_t> volumes() const { return column<std::int64_t>(5); }
+
+  // Index range [first, last) of bars with from_ns <= timestamp < to_ns
+  // Binary search on the (ascending) timestamp column
+  std::pair<std::size_t, std::size_t> range(std::int64_t, std::int64_t) const;
+
+  // Materialise bars [first, last)
+  std::vector<Bar> bars(std::size_t, std::size_t) const;
+
+private:
+  template <typename T> std::span<const T> column(std::size_t index) const {
+    if (count_ == 0)
+      return {};
+    const auto offset = sizeof(BarFileHeader) + index * count_ * sizeof(T);
+    return {reinterpret_cast<const T *>(data_ + offset), count_};
+  }
+
+  const std::byte *data_{};
+  std::size_t size_{};  // Mapped bytes
+  std::size_t count_{}; // Bars (0 unless the file validated)
+};
+
+class BarStore {
+public:
+  explicit BarStore(std::filesystem::path);
+
+  // Map a cached series without copying it (empty if missing or corrupt)
+  MappedBars map(std::string_view, std::string_view) const;
+
+  // Load a cached series (empty if missing or corrupt)
+  std::vector<Bar> load(std::string_view, std::string_view) const;
+
+  // Load only bars with from_ns <= timestamp < to_ns
+  std::vector<Bar> load(std::string_view, std::string_view, std::int64_t,
+                        std::int64_t) const;
+
+  // Replace a cached series (written to a temp file then renamed)
+  bool save(std::string_view, std::string_view, const std::vector<Bar> &) const;
+
+private:
+  std::filesystem::path path_for(std::string_view, std::string_view) const;
+
+  std::filesystem::path dir_;
+};
+
+// Merge freshly fetched bars into a cached series
+// Cached bars at or after the first fresh bar are replaced, so the last bar
+// (which Alpaca revises at :30 to include late trades) is overwritten
+void merge_bars(std::vector<Bar> &, const std::vector<Bar> &);
+
+// Drop bars older than the given epoch ns
+void trim_bars(std::vector<Bar> &, std::int64_t);
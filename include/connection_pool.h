@@ -0,0 +1,57 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include "latency.h"
+#include "rate_limiter.h"
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <httplib.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Pool of long-lived keep-alive clients for a single host
+// Each request leases its own client, so concurrent callers never share a
+// socket; idle clients are parked for reuse and dropped if they fail
+// Every request draws from the host's RateLimiter first, and 429s
+// are retried once the limiter has backed off
+class ConnectionPool {
+public:
+  struct Timeouts {
+    time_t connect{10};
+    time_t read{30};
+  };
+
+  ConnectionPool(std::string, RateLimiter &);
+
+  httplib::Result get(const std::string &, const httplib::Headers &, Timeouts);
+  httplib::Result post(const std::string &, const httplib::Headers &,
+                       const std::string &, const std::string &, Timeouts);
+  httplib::Result del(const std::string &, const httplib::Headers &, Timeouts);
+
+  ConnectionStats stats() const;
+
+private:
+  // Send a request on a leased client, reconnecting once if it fails and
+  // retrying while rate limited
+  template <typename Request>
+  httplib::Result send(Timeouts, bool, Request &&);
+
+  std::unique_ptr<httplib::Client> acquire();
+  void release(std::unique_ptr<httplib::Client>);
+
+  std::string host_;
+  RateLimiter &limiter_;
+  LatencyHistogram &latency_; // Wall time per request, including retries
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<httplib::Client>> idle_;
+
+  std::atomic<std::uint64_t> requests_{};
+  std::atomic<std::uint64_t> handshakes_{};
+  std::atomic<std::uint64_t> reused_{};
+  std::atomic<std::uint64_t> reconnects_{};
+  std::atomic<std::uint64_t> throttled_{};
+  std::atomic<std::uint64_t> rate_limited_{};
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Cross-sectional indicator engine
+// Holds the last rows() bar volumes of every watchlist symbol as a time-major
+// matrix (one row per bar, one column per symbol), so each kernel streams a
+// row at a time and computes an indicator for a whole row of symbols per
+// instruction.
+// Rows are right-aligned: row rows() - 1 is every symbol's latest bar, and
+// symbols with fewer bars have zero rows before their first one
+// Kernels use AVX2 when the CPU has it (checked at runtime, x86 only) and a
+// scalar loop otherwise. Each lane is one symbol and sums in the same order
+// as the scalar loop, so both paths give identical results
+
+// Allocator for SIMD-aligned matrix storage
+template <typename T, std::size_t Alignment = 64> struct AlignedAllocator {
+  using value_type = T;
+
+  AlignedAllocator() = default;
+  template <typename U>
+  constexpr AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+  }
+  void deallocate(T *p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t{Alignment});
+  }
+
+  bool operator==(const AlignedAllocator &) const = default;
+};
+
+class CrossSection {
+public:
+  // Room for the given number of symbols and bars per symbol
+  CrossSection(std::size_t symbols, std::size_t rows);
+
+  // Load a symbol's most recent bars (at most rows()), replacing any held
+  void load(std::size_t symbol, std::span<const Bar>);
+
+  std::size_t symbols() const { return symbols_; }
+  std::size_t rows() const { return rows_; }
+
+  // Bars held for a symbol
+  std::size_t length(std::size_t symbol) const { return lengths_[symbol]; }
+
+  // Latest / average volume over each symbol's last `window` bars, indexed
+  // by symbol. Symbols with fewer bars than the window (or a zero average
+  // volume) get 0.0, matching PriceHistory
+  std::vector<double> volume_ratio(std::size_t window) const;
+
+private:
+  using Matrix = std::vector<double, AlignedAllocator<double>>;
+
+  // Zero indicators for symbols without a full window
+  void mask_short(std::vector<double> &, std::size_t window) const;
+
+  std::size_t symbols_;
+  std::size_t stride_; // Symbols rounded up to a whole SIMD register
+  std::size_t rows_;
+  Matrix volumes_;
+  std::vector<std::size_t> lengths_;
+};
+
+// Mean of values[i] over the i where included[i] is 1.0 (others 0.0), or
+// nullopt if none are included; both spans have the same length
+// Summed in a fixed four-lane order on every CPU so results are reproducible
+std::optional<double> masked_mean(std::span<const double> values,
+                                  std::span<const double> included);
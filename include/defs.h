@@ -4,12 +4,14 @@
 constexpr auto notional_amount = 1000.0;  // Dollar amount per trade
 constexpr auto calibration_days = 30;     // Duration for strategy calibration
 constexpr auto min_trades_to_enable = 10; // Minimum trades to enable strategy
+constexpr auto bar_cache_dir = "cache/bars"; // On-disk bar cache (per series)
 
 // Exit parameters (10/1/0.9 pattern: TP 10%, SL 1%, TS 0.9%)
 constexpr auto take_profit_pct = 0.10;      // 10% take profit threshold
 constexpr auto stop_loss_pct = 0.01;       // 1% stop loss threshold
 constexpr auto trailing_stop_pct = 0.009;   // 0.9% trailing stop threshold
 constexpr auto panic_stop_loss_pct = 0.06; // 3.5% panic stop (safety net)
+constexpr auto exit_monitor_interval_ms = 5000; // Panic stop / EOD check cadence
 
 // Exit parameter validation
 // TP can be 0.0 to disable (let trailing stop or manual exit handle profits)
@@ -36,6 +38,7 @@ constexpr auto max_spread_bps_stocks =
 constexpr auto max_spread_bps_crypto =
     100.0;                             // Max 100 bps (1.00%) spread for crypto
 constexpr auto min_volume_ratio = 0.5; // Min 50% of 20-period average volume
+constexpr auto volume_ratio_bars = 20uz; // Bars averaged for the volume ratio
 
 // Cost estimation (Tier 2 - Edge Reality)
 constexpr auto slippage_buffer_bps =
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include "lft.h"
+#include "spsc_queue.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Panic stops and the EOD cutoff on a thread of their own
+// check_panic_exits runs every exit_monitor_interval_ms while the market is
+// open (the thread sleeps through closed hours), so stop latency doesn't
+// depend on how long the strategy thread's evaluation of the watchlist
+// takes. Per-position state is shared through the PositionBook; the exits
+// made are handed back over a lock-free queue for the strategy thread to
+// report
+class ExitMonitor {
+public:
+  ExitMonitor(AlpacaClient &, std::chrono::system_clock::time_point eod);
+
+  ExitMonitor(const ExitMonitor &) = delete;
+  ExitMonitor &operator=(const ExitMonitor &) = delete;
+
+  // Exits made since the last call (strategy thread only)
+  std::vector<ExitNotice> take_notices();
+
+private:
+  void run(std::stop_token);
+
+  AlpacaClient &client_;
+  std::chrono::system_clock::time_point eod_;
+  SpscQueue<ExitNotice, 256> notices_;
+
+  // Only for sleeping between checks, interruptibly
+  std::mutex mutex_;
+  std::condition_variable_any cv_;
+
+  std::jthread thread_; // Last member: started after everything else exists
+};
+
+// Print exits made by the monitor
+void report_exits(const std::vector<ExitNotice> &);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "bps_utils.h"
+#include <cstddef>
+
+// Streaming indicator accumulators
+// Each updates in O(1) per value: push() while the window is filling, then
+// slide() with the value leaving the window once it is full. The owner (see
+// PriceHistory) keeps the window itself and knows which value is evicted
+
+// Sum over a sliding window
+// Exact for integers; floating-point sums drift slowly, so owners should
+// reset() from the window now and then
+template <typename T> class RunningSum {
+public:
+  constexpr void push(T value) {
+    sum_ += value;
+    ++count_;
+  }
+
+  constexpr void slide(T added, T removed) { sum_ += added - removed; }
+
+  constexpr void reset() {
+    sum_ = T{};
+    count_ = 0;
+  }
+
+  constexpr T sum() const { return sum_; }
+  constexpr std::size_t count() const { return count_; }
+
+private:
+  T sum_{};
+  std::size_t count_{};
+};
+
+// Mean and population variance over a sliding window (Welford's algorithm,
+// extended to replace the oldest value once the window is full)
+class WindowedStats {
+public:
+  constexpr void push(double value) {
+    ++count_;
+    const auto delta = value - mean_;
+    mean_ += delta / static_cast<double>(count_);
+    m2_ += delta * (value - mean_);
+  }
+
+  constexpr void slide(double added, double removed) {
+    if (count_ == 0)
+      return push(added);
+
+    const auto old_mean = mean_;
+    mean_ += (added - removed) / static_cast<double>(count_);
+    m2_ += (added - removed) * (added - mean_ + removed - old_mean);
+  }
+
+  constexpr void reset() {
+    count_ = 0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+  }
+
+  constexpr std::size_t count() const { return count_; }
+  constexpr double mean() const { return mean_; }
+
+  // Divides by count (not count - 1) to match the window scans it replaces
+  // Clamped at zero: rounding can leave a tiny negative for flat windows
+  constexpr double variance() const {
+    if (count_ == 0 or m2_ <= 0.0)
+      return 0.0;
+    return m2_ / static_cast<double>(count_);
+  }
+
+private:
+  std::size_t count_{};
+  double mean_{};
+  double m2_{};
+};
+
+// Compile-time tests for the accumulators
+namespace indicator_tests {
+
+constexpr auto window_of_four(int values_pushed) {
+  // Window [1, 2, 3, 4] then slide in 5, 6, ... evicting the oldest
+  auto stats = WindowedStats{};
+  for (auto i = 1; i <= values_pushed; ++i) {
+    if (i <= 4)
+      stats.push(i);
+    else
+      stats.slide(i, i - 4);
+  }
+  return stats;
+}
+
+static_assert(near(window_of_four(4).mean(), 2.5) and
+                  near(window_of_four(4).variance(), 1.25),
+              "Welford matches mean/variance of [1, 2, 3, 4]");
+static_assert(near(window_of_four(10).mean(), 8.5) and
+                  near(window_of_four(10).variance(), 1.25),
+              "Sliding window matches mean/variance of [7, 8, 9, 10]");
+static_assert(WindowedStats{}.variance() == 0.0, "Empty window has no variance");
+
+constexpr auto volume_sum() {
+  auto sum = RunningSum<long>{};
+  sum.push(100);
+  sum.push(200);
+  sum.slide(300, 100);
+  return sum;
+}
+
+static_assert(volume_sum().sum() == 500 and volume_sum().count() == 2,
+              "Sliding integer sum is exact");
+
+} // namespace indicator_tests
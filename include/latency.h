@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Latency instrumentation
+// Histograms are HDR-style: exact below 16 ns, then 16 linear sub-buckets per
+// power of two, so any recorded value is reported within 1/16 (6.25%) of its
+// true value from nanoseconds up to centuries, in a fixed 976 buckets.
+// record() is a handful of relaxed atomic adds, so timers can wrap hot calls
+// on any thread without locks
+
+class LatencyHistogram {
+public:
+  static constexpr auto sub_bucket_bits = 4;
+  static constexpr auto sub_buckets = std::uint64_t{1} << sub_bucket_bits;
+  static constexpr auto bucket_count =
+      (64 - sub_bucket_bits) * sub_buckets + sub_buckets;
+
+  // Bucket holding a value in ns
+  static constexpr std::size_t bucket_index(std::uint64_t ns) {
+    if (ns < sub_buckets)
+      return static_cast<std::size_t>(ns);
+    const auto shift = std::bit_width(ns) - sub_bucket_bits - 1;
+    return static_cast<std::size_t>((shift + 1) * sub_buckets +
+                                    ((ns >> shift) - sub_buckets));
+  }
+
+  // Largest value in ns that lands in a bucket
+  static constexpr std::uint64_t bucket_upper(std::size_t index) {
+    if (index < sub_buckets)
+      return index;
+    const auto shift = index / sub_buckets - 1;
+    const auto sub = index % sub_buckets + sub_buckets;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  void record(std::chrono::nanoseconds);
+
+  std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  std::chrono::nanoseconds max() const;
+
+  // Value at or below which the given percentage (0-100] of samples fall,
+  // rounded up to its bucket (and capped at the max)
+  std::chrono::nanoseconds percentile(double) const;
+
+  void reset();
+
+private:
+  std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+  std::atomic<std::uint64_t> count_{};
+  std::atomic<std::uint64_t> max_{};
+};
+
+// Named histogram, created on first use and kept for the process lifetime
+// Look it up once (e.g. into a function-local static) and record freely;
+// only the lookup takes a lock
+LatencyHistogram &latency_histogram(std::string_view);
+
+// Print count / p50 / p99 / max of every histogram with samples, in
+// registration order
+void print_latency_report();
+
+// Records the time from construction to destruction
+class ScopedTimer {
+public:
+  explicit ScopedTimer(LatencyHistogram &histogram)
+      : histogram_{histogram}, start_{std::chrono::steady_clock::now()} {}
+
+  ~ScopedTimer() {
+    histogram_.record(std::chrono::steady_clock::now() - start_);
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+  LatencyHistogram &histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Compile-time tests for the bucket layout
+namespace latency_tests {
+
+using H = LatencyHistogram;
+
+static_assert(H::bucket_index(0) == 0 and H::bucket_index(15) == 15 and
+                  H::bucket_index(16) == 16 and H::bucket_index(31) == 31,
+              "Small values have exact buckets");
+static_assert(H::bucket_index(32) == 32 and H::bucket_index(33) == 32 and
+                  H::bucket_index(63) == 47 and H::bucket_index(64) == 48,
+              "Each power of two splits into 16 buckets");
+static_assert(H::bucket_index(~std::uint64_t{0}) == H::bucket_count - 1,
+              "Largest value lands in the last bucket");
+static_assert([] {
+  for (auto i = 0uz; i < H::bucket_count; ++i)
+    if (H::bucket_index(H::bucket_upper(i)) != i or
+        (i + 1 < H::bucket_count and
+         H::bucket_index(H::bucket_upper(i) + 1) != i + 1))
+      return false;
+  return true;
+}(), "Buckets are contiguous and upper bounds round-trip");
+static_assert(H::bucket_upper(H::bucket_index(1'000'000)) - 1'000'000 <=
+                  1'000'000 / H::sub_buckets,
+              "Relative error is bounded by the sub-bucket count");
+
+} // namespace latency_tests
@@ -1,10 +1,12 @@
 #pragma once
 
 #include "alpaca_client.h"
+#include "strategies.h"
 #include <chrono>
 #include <map>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Market assessment result
@@ -23,17 +25,25 @@ struct BacktestPosition {
   double peak_price{};
 };
 
-// Forward declare StrategyStats (defined in strategies.h)
-struct StrategyStats;
+// Forward declare MarketDataCache (defined in market_data_cache.h)
+class MarketDataCache;
 
 // Data fetching and assessment
+// Batched snapshots for a whole symbol set (empty map on failure)
+std::map<std::string, Snapshot> fetch_snapshot_map(AlpacaClient &, const std::vector<std::string> &);
 std::vector<Snapshot> fetch_snapshots(AlpacaClient &);
 std::map<std::string, std::vector<Bar>> fetch_bars(AlpacaClient &);
 MarketAssessment assess_market_conditions(AlpacaClient &, const std::vector<Snapshot> &);
 
 // Phase 1: Calibrate strategies on historic bar data
-// Returns map of strategy name -> enabled status
-std::map<std::string, bool> calibrate(const std::map<std::string, std::vector<Bar>> &, double);
+// Strategies are backtested concurrently on the given number of threads
+// Returns the set of strategies enabled for live trading
+StrategyMask calibrate(const std::map<std::string, std::vector<Bar>> &, double, std::size_t);
+
+// Backtest a grid of exit thresholds (TP/SL/trailing/panic) in one sweep over
+// the bars and print them ranked by the P&L of the strategies calibration
+// would enable (lft --sweep)
+void sweep_exit_params(const std::map<std::string, std::vector<Bar>> &, double, std::size_t);
 
 // Market evaluation structures
 struct SymbolEvaluation {
@@ -45,7 +55,7 @@ struct SymbolEvaluation {
   double daily_change_pct{};  // Daily change percentage (for market breadth)
   bool tradeable{};
   bool ready_to_trade{};  // True if tradeable AND has at least one signal
-  std::map<std::string, bool> strategy_signals;
+  StrategyMask strategy_signals;  // Enabled strategies with a buy signal
   std::string status_summary;
 };
 
@@ -57,29 +67,45 @@ struct MarketEvaluation {
 };
 
 // Evaluate market conditions and strategy signals (runs every minute)
-MarketEvaluation evaluate_market(AlpacaClient &, const std::map<std::string, bool> &, const std::set<std::string> &);
-void display_evaluation(const MarketEvaluation &, const std::map<std::string, bool> &, std::chrono::system_clock::time_point);
+MarketEvaluation evaluate_market(AlpacaClient &, const MarketDataCache &, StrategyMask, const std::set<std::string> &);
+void display_evaluation(const MarketEvaluation &, StrategyMask, std::chrono::system_clock::time_point);
 
 // Phase 2: Check entry signals and execute trades (every 15 minutes)
-void check_entries(AlpacaClient &, const std::map<std::string, bool> &);
+void check_entries(AlpacaClient &, const MarketDataCache &, StrategyMask);
 
 // Phase 3a: Check normal exit conditions (TP/SL/trailing - every 15 minutes)
 void check_normal_exits(AlpacaClient &, std::chrono::system_clock::time_point);
 
-// Phase 3b: Check panic exit conditions (every 1 minute - fast reaction)
-// Includes: catastrophic loss stops, EOD liquidation
-void check_panic_exits(AlpacaClient &, std::chrono::system_clock::time_point, std::chrono::system_clock::time_point);
+// A position closed (or not) by check_panic_exits
+struct ExitNotice {
+  std::string symbol;
+  std::string_view reason; // "PANIC STOP" or "EOD CUTOFF"
+  double unrealized_pl{};
+  double pl_pct{};
+  std::chrono::system_clock::time_point at;
+  bool closed{};
+};
+
+// Phase 3b: Check panic exit conditions (every few seconds on the exit
+// monitor thread - fast reaction, see exit_monitor.h)
+// Includes: catastrophic loss stops, EOD liquidation, trailing peak updates
+std::vector<ExitNotice> check_panic_exits(AlpacaClient &, std::chrono::system_clock::time_point, std::chrono::system_clock::time_point);
 
 // Phase 4: Emergency liquidation of all equity positions (EOD)
 void liquidate_all(AlpacaClient &);
 
+// Close positions concurrently (results in the same order as the positions)
+std::vector<std::expected<std::string, AlpacaError>>
+close_positions(AlpacaClient &, const std::vector<Position> &);
+
 // Account summary: Display account balances and positions
 void display_account_summary(AlpacaClient &);
 
 // Timing helpers
 std::chrono::system_clock::time_point next_whole_hour(std::chrono::system_clock::time_point);
 std::chrono::system_clock::time_point next_15_minute_bar(std::chrono::system_clock::time_point);
-std::chrono::system_clock::time_point next_minute_at_35_seconds(std::chrono::system_clock::time_point);
+std::chrono::system_clock::time_point next_whole_minute(std::chrono::system_clock::time_point);
+std::chrono::system_clock::time_point market_open_time(std::chrono::system_clock::time_point);
 std::chrono::system_clock::time_point eod_cutoff_time(std::chrono::system_clock::time_point);
 std::chrono::system_clock::time_point session_start_time(std::chrono::system_clock::time_point);
 bool is_market_hours(std::chrono::system_clock::time_point);
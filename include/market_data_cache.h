@@ -0,0 +1,106 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include "cross_section.h"
+#include "strategies.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// In-process 15-minute bar series for the watchlist, shared by every phase of
+// the minute cycle (evaluation, relative strength and entries)
+// refresh() only asks the API for bars newer than those already held; the
+// last held bar is refetched because Alpaca revises it at :30
+class MarketDataCache {
+public:
+  explicit MarketDataCache(std::vector<std::string>, std::size_t = 100);
+
+  // Seed from bars already fetched for calibration
+  void seed(const std::map<std::string, std::vector<Bar>> &);
+
+  // Fetch and append new bars for every symbol (false if a fetch failed)
+  // Symbols are fetched from their own last held bar, grouped by start
+  bool refresh(AlpacaClient &);
+
+  // Streamed updates (see MarketStream)
+  // Bars are folded into the 15-minute bar they fall in; bars for minutes
+  // the bars held already include are ignored
+  void apply_bar(const std::string &, const Bar &);
+  void apply_quote(const std::string &, double, double, std::int64_t);
+  void apply_trade(const std::string &, double, std::int64_t);
+
+  // Replace snapshot prices/quotes with streamed values that are newer
+  void overlay_snapshots(std::map<std::string, Snapshot> &) const;
+
+  // Bars held for a symbol (nullptr if none)
+  const std::vector<Bar> *bars(std::string_view) const;
+
+  // Price history built from the held bars (empty if none)
+  PriceHistory history(std::string_view) const;
+
+  // Price histories for every symbol with data (updated with each bar)
+  const std::map<std::string, PriceHistory> &histories() const {
+    return histories_;
+  }
+
+  // Strategy state fed with every held bar (nullptr if no bars)
+  const StrategySet *strategies(std::string_view) const;
+
+  // Market-wide strategy inputs for the latest bars
+  MarketContext market_context() const;
+
+  // Latest / average volume over each watchlist symbol's last
+  // volume_ratio_bars bars (0.0 with fewer bars), from the cross-sectional
+  // engine; the one definition used by evaluation and entries
+  std::map<std::string, double, std::less<>> volume_ratios() const;
+
+private:
+  void rebuild_histories();
+
+  // Replay a symbol's bars into its history and strategy state
+  void rebuild_symbol(const std::string &);
+
+  // Reload a watchlist symbol's column of the volume matrix
+  void load_volumes(std::string_view);
+
+  // Bring a symbol's state up to date after its bars from the given
+  // timestamp on were appended or modified (bars before it are unchanged)
+  // Only new bars and a modified last bar are applied; anything earlier
+  // replays the whole series
+  void update_symbol(const std::string &, std::int64_t changed_from);
+
+  std::vector<std::string> symbols_;
+  std::size_t max_bars_;
+
+  // Latest volume_ratio_bars volumes of every watchlist symbol, one column
+  // per symbol in watchlist order, reloaded as each symbol's bars change
+  CrossSection volumes_;
+  std::map<std::string, std::vector<Bar>, std::less<>> bars_;
+
+  // Epoch ns up to which each symbol's last bar already includes trades
+  std::map<std::string, std::int64_t, std::less<>> covered_until_;
+  std::map<std::string, PriceHistory> histories_;
+  std::map<std::string, StrategySet, std::less<>> strategy_sets_;
+
+  // Each symbol's state before its last bar, so a last bar updated in place
+  // is re-applied on top of it rather than replaying every held bar
+  struct SettledState {
+    PriceHistory history;
+    StrategySet strategies;
+    std::int64_t last_bar{}; // Timestamp of the bar applied after this state
+  };
+  std::map<std::string, SettledState, std::less<>> settled_;
+
+  // Latest streamed trade/quote per symbol (timestamps epoch ns, 0 = none)
+  struct LiveQuote {
+    double bid{};
+    double ask{};
+    std::int64_t quote_timestamp{};
+    double price{};
+    std::int64_t trade_timestamp{};
+  };
+  std::map<std::string, LiveQuote> live_;
+};
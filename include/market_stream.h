@@ -0,0 +1,75 @@
+#pragma once
+
+#include "alpaca_client.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class MarketDataCache;
+
+// A single streamed market data update
+struct StreamEvent {
+  enum class Type { Bar, Quote, Trade };
+
+  Type type{};
+  std::string symbol;
+  Bar bar;        // Type::Bar
+  double bid{};   // Type::Quote
+  double ask{};   // Type::Quote
+  double price{}; // Type::Trade
+  std::int64_t timestamp{}; // Epoch ns
+};
+
+// Push-based market data feed
+// Speaks Alpaca's stream protocol (auth/subscribe requests, then JSON arrays
+// of "b"/"q"/"t" messages) as newline-delimited JSON over TCP. Point it at
+// lft_replay for offline testing, or at a local WebSocket bridge for the live
+// feed, e.g.:
+//   websocat --text tcp-l:127.0.0.1:8765 wss://stream.data.alpaca.markets/v2/iex
+// A reader thread queues updates; the trading loop applies them with drain()
+class MarketStream {
+public:
+  MarketStream(std::string_view, std::vector<std::string>);
+  ~MarketStream();
+
+  MarketStream(const MarketStream &) = delete;
+  MarketStream &operator=(const MarketStream &) = delete;
+
+  // Block until an update arrives or the deadline passes
+  // Returns true if updates are waiting to be drained
+  bool wait_until(std::chrono::system_clock::time_point);
+
+  // Apply queued updates to the cache (returns number of updates applied)
+  std::size_t drain(MarketDataCache &);
+
+  bool connected() const { return connected_; }
+  std::uint64_t messages_received() const { return messages_; }
+
+private:
+  void run(std::stop_token);
+  bool connect_and_subscribe();
+  void handle_line(std::string_view);
+
+  std::string host_;
+  std::string port_;
+  std::string key_;
+  std::string secret_;
+  std::vector<std::string> symbols_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<StreamEvent> pending_;
+
+  std::atomic<int> fd_{-1};
+  std::atomic<bool> connected_{false};
+  std::atomic<std::uint64_t> messages_{};
+
+  std::jthread thread_; // Last member: started after everything else exists
+};
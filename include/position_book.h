@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+
+// Per-position tracking shared by the strategy thread and the exit monitor
+// (see exit_monitor.h). Each call holds the lock for a few map operations;
+// no API request is ever made under it.
+// Closing is claimed per symbol, so a position that one thread is already
+// closing is skipped by the other rather than closed twice
+class PositionBook {
+public:
+  using time_point = std::chrono::system_clock::time_point;
+
+  // An entry order was accepted for a symbol
+  void opened(const std::string &, std::string_view strategy, time_point);
+
+  // Whether an entry has been recorded (its position may not be open yet)
+  bool entered(std::string_view) const;
+
+  // Raise a symbol's peak price to price if it is higher; returns the peak
+  double update_peak(const std::string &, double price);
+
+  // Claim a symbol for closing (false if it is already being closed)
+  bool begin_close(const std::string &);
+
+  // Release a claim; a successful close also drops the symbol's tracking
+  void finish_close(const std::string &, bool closed);
+
+private:
+  mutable std::mutex mutex_;
+  std::map<std::string, std::string, std::less<>> strategies_; // Entry strategy
+  std::map<std::string, time_point, std::less<>> entry_times_;
+  std::map<std::string, double, std::less<>> peaks_; // For trailing stops
+  std::set<std::string, std::less<>> closing_;
+};
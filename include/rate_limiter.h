@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+// Token bucket sized to one API host's request quota
+// Every request takes one token before it is sent; tokens refill continuously
+// at the current rate up to a burst of a few seconds' worth, so callers run
+// flat out while under the quota and are spaced out evenly once they reach it
+// The rate adapts AIMD-style: a 429 halves it and holds every caller until
+// the server's reset time, then each accepted request wins a little back, up
+// to the quota
+class RateLimiter {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit RateLimiter(double requests_per_minute);
+
+  RateLimiter(const RateLimiter &) = delete;
+  RateLimiter &operator=(const RateLimiter &) = delete;
+
+  // Block until a request may be sent; true if it had to wait
+  bool acquire();
+
+  // The server accepted a request (quota is its X-RateLimit-Limit, if sent)
+  void accepted(double quota_per_minute = 0.0);
+
+  // The server answered 429: slow down and hold every caller until resume
+  void rejected(clock::time_point resume);
+
+  // Requests that can go out back to back at the full quota
+  std::size_t burst() const;
+
+private:
+  // Add the tokens earned since the last refill (none before a pause ends)
+  void refill(clock::time_point);
+
+  mutable std::mutex mutex_;
+  double quota_;  // Requests per second the host allows
+  double rate_;   // Requests per second currently allowed (<= quota_)
+  double tokens_; // Negative while callers are waiting on future tokens
+  clock::time_point last_refill_;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+// Fixed-capacity ring buffer that keeps its contents contiguous
+// Each value is written twice, at slot i and slot i + N, so the most recent
+// size() values always form one contiguous run and last(n) is a plain span
+// (no wrap-around, no allocation). Pushing onto a full buffer evicts the
+// oldest value
+template <typename T, std::size_t N> class RingBuffer {
+public:
+  static_assert(N > 0, "Ring buffer needs a non-zero capacity");
+
+  constexpr void push_back(T value) {
+    data_[next_] = value;
+    data_[next_ + N] = value;
+    next_ = next_ + 1 == N ? 0 : next_ + 1;
+    if (size_ < N)
+      ++size_;
+  }
+
+  constexpr void clear() {
+    next_ = 0;
+    size_ = 0;
+  }
+
+  static constexpr std::size_t capacity() { return N; }
+  constexpr std::size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+
+  // Oldest first
+  constexpr const T *data() const { return data_.data() + start(); }
+  constexpr const T *begin() const { return data(); }
+  constexpr const T *end() const { return data() + size_; }
+
+  constexpr const T &operator[](std::size_t i) const { return data()[i]; }
+  constexpr const T &front() const { return data()[0]; }
+  constexpr const T &back() const { return data()[size_ - 1]; }
+
+  // All held values, oldest first
+  constexpr std::span<const T> span() const { return {data(), size_}; }
+
+  // Most recent n values, oldest first (n must not exceed size())
+  constexpr std::span<const T> last(std::size_t n) const {
+    return span().last(n);
+  }
+
+private:
+  constexpr std::size_t start() const {
+    return next_ >= size_ ? next_ - size_ : next_ + N - size_;
+  }
+
+  std::array<T, 2 * N> data_{};
+  std::size_t next_{}; // Slot the next value is written to
+  std::size_t size_{};
+};
+
+// Compile-time tests for the ring buffer
+namespace ring_buffer_tests {
+
+constexpr auto filled(std::size_t count) {
+  auto ring = RingBuffer<int, 4>{};
+  for (auto i = 1uz; i <= count; ++i)
+    ring.push_back(static_cast<int>(i));
+  return ring;
+}
+
+static_assert(filled(0).empty(), "New ring buffer is empty");
+static_assert(filled(3).size() == 3 and filled(3).front() == 1 and
+                  filled(3).back() == 3,
+              "Partially filled buffer keeps insertion order");
+static_assert(filled(6).size() == 4 and filled(6).front() == 3 and
+                  filled(6).back() == 6,
+              "Full buffer evicts the oldest value");
+static_assert(filled(7).last(3)[0] == 5 and filled(7).last(3)[2] == 7,
+              "last(n) is the most recent n values after wrap-around");
+static_assert(filled(9)[0] == 6 and filled(9)[3] == 9,
+              "Indexing is oldest first after several wraps");
+
+} // namespace ring_buffer_tests
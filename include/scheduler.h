@@ -0,0 +1,67 @@
+#pragma once
+
+#include "latency.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Deadline-driven task scheduler for the trading loop
+// Tasks are held in a priority queue by deadline; each one runs once its
+// deadline has passed and returns its next, so the loop can sleep until
+// next_deadline() instead of polling. Tasks due at the same time run in the
+// order they were added, which fixes the order of a cycle's phases.
+// How late each task starts is recorded in a "sched.<name>" histogram
+class Scheduler {
+public:
+  using clock = std::chrono::system_clock;
+
+  // Runs a task at (or after) its deadline and returns the next one;
+  // never() retires it
+  using Task = std::function<clock::time_point(clock::time_point)>;
+
+  static constexpr clock::time_point never() {
+    return clock::time_point::max();
+  }
+
+  // Add a task first due at the given time
+  void add(std::string, clock::time_point, Task);
+
+  // Earliest pending deadline (never() if no tasks are left)
+  clock::time_point next_deadline() const;
+
+  // Run every task due at or before now, in deadline order
+  // A task that reschedules itself at or before now waits for the next call
+  // Returns how many tasks ran
+  std::size_t run_due(clock::time_point);
+
+  // Pending tasks after now, soonest first, for display
+  std::vector<std::pair<std::string, clock::time_point>>
+  upcoming(clock::time_point) const;
+
+private:
+  struct Entry {
+    clock::time_point deadline;
+    std::size_t task; // Index into tasks_, also the tie-break
+  };
+
+  struct Later {
+    bool operator()(const Entry &a, const Entry &b) const {
+      return a.deadline != b.deadline ? a.deadline > b.deadline
+                                      : a.task > b.task;
+    }
+  };
+
+  struct Scheduled {
+    std::string name;
+    Task run;
+    clock::time_point deadline;
+    LatencyHistogram *lateness;
+  };
+
+  std::vector<Scheduled> tasks_;
+  std::priority_queue<Entry, std::vector<Entry>, Later> queue_;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+// Bounded single-producer single-consumer queue
+// One thread pushes and one thread pops, without locks: each side owns one
+// index and publishes it with a release store, so a slot changes hands only
+// once it has been written (or emptied). Indices count up forever and are
+// masked into the ring, so full and empty differ without a spare slot
+template <typename T, std::size_t N> class SpscQueue {
+public:
+  static_assert(N > 0 and (N & (N - 1)) == 0,
+                "Queue capacity must be a power of two");
+
+  // Producer only: false (and value dropped) if the queue is full
+  bool try_push(T value) {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == N)
+      return false;
+    slots_[tail & (N - 1)] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only: nullopt if the queue is empty
+  std::optional<T> try_pop() {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+      return std::nullopt;
+    auto value = std::move(slots_[head & (N - 1)]);
+    head_.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+  static constexpr std::size_t capacity() { return N; }
+
+private:
+  std::array<T, N> slots_{};
+
+  // On separate cache lines so the two threads don't contend for one line
+  alignas(64) std::atomic<std::size_t> head_{}; // Next slot to pop
+  alignas(64) std::atomic<std::size_t> tail_{}; // Next slot to push
+};
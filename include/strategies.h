@@ -2,17 +2,26 @@
 
 #include "alpaca_client.h"
 #include "bps_utils.h"
+#include "indicators.h"
+#include "ring_buffer.h"
+#include <array>
+#include <bit>
 #include <cmath>
-#include <deque>
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 // Strategy result indicating whether to buy and why
 struct StrategySignal {
     bool should_buy{false};
     std::string reason;
-    std::string strategy_name;
+    std::string_view strategy_name;  // Always a string literal (strategy names are static)
     double confidence{1.0};      // Signal confidence: 0.0-1.0 (reduced by noise/low volume)
     double expected_move_bps{0.0}; // Expected price move in basis points (for cost/edge calculation)
 };
@@ -78,19 +87,40 @@ struct StrategyStats {
     }
 };
 
+// Bars kept per symbol for indicators
+constexpr auto max_history_size = 100uz;
+
+// Indicator windows the strategies use (maintained incrementally)
+constexpr auto ma_short_periods = 5uz;
+constexpr auto ma_long_periods = 20uz;
+constexpr auto noise_periods = 20uz;
+
 // Price history with multiple timeframes
+// One fixed-capacity ring buffer per field (structure of arrays), so adding a
+// bar never allocates and indicators read contiguous spans
+// The indicator windows above are kept as running accumulators, so the
+// matching moving_average / price_std_dev / recent_noise / avg_volume /
+// volatility calls are O(1); other window lengths fall back to a scan
 struct PriceHistory {
-    std::deque<double> prices;
-    std::deque<double> highs;     // High prices for noise calculation
-    std::deque<double> lows;      // Low prices for noise calculation
-    std::deque<long> volumes;     // Trading volumes
+    RingBuffer<double, max_history_size> prices;
+    RingBuffer<double, max_history_size> highs;     // High prices for noise calculation
+    RingBuffer<double, max_history_size> lows;      // Low prices for noise calculation
+    RingBuffer<long, max_history_size> volumes;     // Trading volumes
     double last_price{};
     double change_percent{};
     bool has_history{false};
-    std::string last_trade_timestamp;  // Track last trade to avoid duplicates
+    std::int64_t last_trade_timestamp{};  // Epoch ns of last trade, to avoid duplicates
+
+    // Incremental indicator state (see indicators.h)
+    RunningSum<double> ma_short_sum;    // Last ma_short_periods prices
+    WindowedStats price_stats;          // Last ma_long_periods prices
+    RunningSum<double> noise_sum;       // Last noise_periods (high - low) / close
+    RunningSum<long> volume_sum;        // All held volumes
+    WindowedStats return_stats;         // Returns between all held prices
+    std::size_t updates_since_rebuild{};
 
     // Member function declarations (implementations in strategies.cxx)
-    void add_price_with_timestamp(double, std::string_view);
+    void add_price_with_timestamp(double, std::int64_t);
     void add_price(double);
     void add_bar(double, double, double, long);
     double moving_average(size_t) const;
@@ -99,6 +129,14 @@ struct PriceHistory {
     double recent_noise(size_t = 20) const;
     long avg_volume() const;
     double volume_factor() const;
+
+    // Recompute the floating-point accumulators from the buffers, bounding
+    // rounding drift (done every max_history_size updates)
+    void rebuild_indicators();
+
+private:
+    // Append a price and update the price-based indicators
+    void push_price(double);
 };
 
 // Strategy evaluation functions
@@ -107,17 +145,16 @@ public:
     // Buy on price dip
     static StrategySignal evaluate_dip(const PriceHistory&, double);
 
-    // Buy on moving average crossover
-    static StrategySignal evaluate_ma_crossover(const PriceHistory&);
-
     // Buy on mean reversion
     static StrategySignal evaluate_mean_reversion(const PriceHistory&);
 
-    // Buy on volatility breakout
-    static StrategySignal evaluate_volatility_breakout(const PriceHistory&);
-
     // Buy on relative strength (compare to market average)
     static StrategySignal evaluate_relative_strength(const PriceHistory&, const std::map<std::string, PriceHistory>&);
+    static StrategySignal evaluate_relative_strength(const PriceHistory&, std::optional<double>);
+
+    // Average change percent across assets with history (nullopt if none)
+    // Lets callers evaluating many symbols compute the market average once
+    static std::optional<double> market_average_change(const std::map<std::string, PriceHistory>&);
 
     // Buy on volume surge with momentum
     static StrategySignal evaluate_volume_surge(const PriceHistory&);
@@ -126,3 +163,173 @@ public:
     static double calculate_spread_bps(const Snapshot&);
     static double calculate_volume_ratio(const PriceHistory&);
 };
+
+// Market-wide inputs shared by every symbol at a bar
+struct MarketContext {
+    std::optional<double> average_change;  // Mean change_percent of symbols with history (masked_mean)
+};
+
+// Stateful strategies
+// Each symbol owns one object per strategy. on_bar() is called once for every
+// bar after it is added to the symbol's PriceHistory and updates the
+// strategy's rolling state; signal() then evaluates the latest bar in O(1)
+// without allocating (reasons are only formatted for buy signals)
+
+class MaCrossoverStrategy {
+public:
+    static constexpr auto name = std::string_view{"ma_crossover"};
+    void on_bar(const PriceHistory&);
+    StrategySignal signal(const PriceHistory&, const MarketContext&) const;
+
+private:
+    double ma_short_{};        // MAs as of the latest bar
+    double ma_long_{};
+    double prev_ma_short_{};   // MAs as of the bar before
+    double prev_ma_long_{};
+    bool has_ma_{false};
+    bool has_prev_ma_{false};
+};
+
+class MeanReversionStrategy {
+public:
+    static constexpr auto name = std::string_view{"mean_reversion"};
+    void on_bar(const PriceHistory&) {}
+    StrategySignal signal(const PriceHistory&, const MarketContext&) const;
+};
+
+class VolatilityBreakoutStrategy {
+public:
+    static constexpr auto name = std::string_view{"volatility_breakout"};
+    void on_bar(const PriceHistory&);
+    StrategySignal signal(const PriceHistory&, const MarketContext&) const;
+
+private:
+    RingBuffer<double, 4> recent_changes_;  // Absolute returns of the last 4 bars
+};
+
+class RelativeStrengthStrategy {
+public:
+    static constexpr auto name = std::string_view{"relative_strength"};
+    void on_bar(const PriceHistory&) {}
+    StrategySignal signal(const PriceHistory&, const MarketContext&) const;
+};
+
+class VolumeSurgeStrategy {
+public:
+    static constexpr auto name = std::string_view{"volume_surge"};
+    void on_bar(const PriceHistory&) {}
+    StrategySignal signal(const PriceHistory&, const MarketContext&) const;
+};
+
+// Strategy registry
+// Every strategy type, in ID order. Adding a strategy means writing its class
+// above and listing it here; IDs, names, dispatch and enable masks follow
+using StrategyTypes = std::tuple<
+    MaCrossoverStrategy,
+    MeanReversionStrategy,
+    VolatilityBreakoutStrategy,
+    RelativeStrengthStrategy,
+    VolumeSurgeStrategy>;
+
+constexpr auto strategy_count = std::tuple_size_v<StrategyTypes>;
+
+// Dense strategy ID: index into StrategyTypes
+using StrategyId = std::size_t;
+
+template <StrategyId Id>
+using StrategyType = std::tuple_element_t<Id, StrategyTypes>;
+
+// Call f(std::integral_constant<StrategyId, Id>{}) for every strategy, in ID
+// order, so f can use the ID as a compile-time constant
+template <typename F>
+constexpr void for_each_strategy(F&& f) {
+    [&]<StrategyId... Id>(std::index_sequence<Id...>) {
+        (f(std::integral_constant<StrategyId, Id>{}), ...);
+    }(std::make_index_sequence<strategy_count>{});
+}
+
+// Strategy names by ID
+constexpr auto strategy_names = []<StrategyId... Id>(std::index_sequence<Id...>) {
+    return std::array<std::string_view, strategy_count>{StrategyType<Id>::name...};
+}(std::make_index_sequence<strategy_count>{});
+
+// ID for a strategy name (nullopt if unknown)
+constexpr std::optional<StrategyId> find_strategy(std::string_view name) {
+    for (auto id = 0uz; id < strategy_count; ++id)
+        if (strategy_names[id] == name)
+            return id;
+    return std::nullopt;
+}
+
+// Set of strategies, one bit per StrategyId
+class StrategyMask {
+public:
+    static_assert(strategy_count <= 32, "Strategy mask holds up to 32 strategies");
+
+    static constexpr StrategyMask all() {
+        auto mask = StrategyMask{};
+        mask.bits_ = static_cast<std::uint32_t>((std::uint64_t{1} << strategy_count) - 1);
+        return mask;
+    }
+
+    constexpr bool test(StrategyId id) const { return (bits_ >> id) & 1u; }
+    constexpr void set(StrategyId id, bool on = true) {
+        bits_ = on ? bits_ | (1u << id) : bits_ & ~(1u << id);
+    }
+
+    constexpr std::size_t count() const { return static_cast<std::size_t>(std::popcount(bits_)); }
+    constexpr bool any() const { return bits_ != 0; }
+
+    constexpr bool operator==(const StrategyMask&) const = default;
+
+private:
+    std::uint32_t bits_{};
+};
+
+// One of each strategy for a single symbol
+struct StrategySet {
+    StrategyTypes strategies;
+
+    void on_bar(const PriceHistory& history) {
+        std::apply([&](auto&... strategy) { (strategy.on_bar(history), ...); }, strategies);
+    }
+
+    // Signal from a strategy chosen at compile time
+    template <StrategyId Id>
+    StrategySignal signal(const PriceHistory& history, const MarketContext& market) const {
+        return std::get<Id>(strategies).signal(history, market);
+    }
+
+    // Signals from every strategy, indexed by StrategyId
+    std::array<StrategySignal, strategy_count> signals(const PriceHistory& history,
+                                                       const MarketContext& market) const {
+        return std::apply([&](const auto&... strategy) {
+            return std::array<StrategySignal, strategy_count>{strategy.signal(history, market)...};
+        }, strategies);
+    }
+};
+
+// Compile-time tests for the registry
+static_assert(strategy_names[0] == "ma_crossover" and
+                  strategy_names[strategy_count - 1] == "volume_surge",
+              "Names follow registry order");
+static_assert(find_strategy("relative_strength") == 3uz and
+                  not find_strategy("dip"),
+              "Names map back to dense IDs");
+static_assert([] {
+    for (auto a = 0uz; a < strategy_count; ++a)
+        for (auto b = a + 1; b < strategy_count; ++b)
+            if (strategy_names[a] == strategy_names[b])
+                return false;
+    return true;
+}(), "Strategy names are unique");
+static_assert(StrategyMask::all().count() == strategy_count and
+                  not StrategyMask{}.any(),
+              "Mask covers exactly the registered strategies");
+static_assert([] {
+    auto mask = StrategyMask{};
+    mask.set(1);
+    mask.set(4);
+    mask.set(1, false);
+    return not mask.test(1) and mask.test(4) and mask.count() == 1;
+}(), "Mask bits set and clear independently");
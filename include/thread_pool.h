@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed-size pool of worker threads
+// submit() returns a future, so callers collect results in whatever order
+// they submitted them regardless of which task finishes first
+// Queued tasks are still run when the pool is destroyed
+class ThreadPool {
+public:
+  // 0 threads means one per hardware thread
+  explicit ThreadPool(std::size_t = 0);
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  template <typename F> auto submit(F &&task) {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+
+    auto packaged = std::packaged_task<Result()>{std::forward<F>(task)};
+    auto result = packaged.get_future();
+    {
+      auto lock = std::lock_guard{mutex_};
+      queue_.emplace_back(std::move(packaged));
+    }
+    cv_.notify_one();
+
+    return result;
+  }
+
+  std::size_t size() const { return workers_.size(); }
+
+private:
+  void run(std::stop_token);
+
+  std::mutex mutex_;
+  std::condition_variable_any cv_;
+  std::deque<std::move_only_function<void()>> queue_;
+
+  std::vector<std::jthread> workers_; // Last member: joined before the queue goes
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// ISO 8601 / RFC 3339 timestamp conversion for API data
+// Timestamps are held as nanoseconds since the Unix epoch (UTC)
+
+constexpr auto ns_per_second = std::int64_t{1'000'000'000};
+constexpr auto ns_per_minute = 60 * ns_per_second;
+constexpr auto ns_per_hour = 60 * ns_per_minute;
+constexpr auto ns_per_day = 86400 * ns_per_second;
+
+namespace detail {
+
+constexpr bool parse_digits(std::string_view text, std::size_t pos,
+                            std::size_t count, int &value) {
+  if (pos + count > text.size())
+    return false;
+
+  value = 0;
+  for (auto i = pos; i < pos + count; ++i) {
+    if (text[i] < '0' or text[i] > '9')
+      return false;
+    value = value * 10 + (text[i] - '0');
+  }
+
+  return true;
+}
+
+} // namespace detail
+
+// Parse "YYYY-MM-DDTHH:MM:SS[.fffffffff]Z" to epoch nanoseconds
+// Returns 0 for malformed input
+constexpr std::int64_t parse_timestamp_ns(std::string_view text) {
+  auto year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+
+  if (not detail::parse_digits(text, 0, 4, year) or
+      not detail::parse_digits(text, 5, 2, month) or
+      not detail::parse_digits(text, 8, 2, day) or
+      not detail::parse_digits(text, 11, 2, hour) or
+      not detail::parse_digits(text, 14, 2, minute) or
+      not detail::parse_digits(text, 17, 2, second))
+    return 0;
+
+  // Optional fractional seconds (up to nanosecond precision)
+  auto fraction = std::int64_t{};
+  if (text.size() > 19 and text[19] == '.') {
+    auto digits = 0;
+    for (auto i = 20uz; i < text.size() and text[i] >= '0' and text[i] <= '9';
+         ++i) {
+      if (digits < 9) {
+        fraction = fraction * 10 + (text[i] - '0');
+        ++digits;
+      }
+    }
+    for (; digits < 9; ++digits)
+      fraction *= 10;
+  }
+
+  using namespace std::chrono;
+  const auto date = year_month_day{std::chrono::year{year},
+                                   std::chrono::month{static_cast<unsigned>(month)},
+                                   std::chrono::day{static_cast<unsigned>(day)}};
+  if (not date.ok())
+    return 0;
+
+  const auto days_since_epoch = sys_days{date}.time_since_epoch().count();
+  const auto seconds = std::int64_t{days_since_epoch} * 86400 + hour * 3600 +
+                       minute * 60 + second;
+
+  return seconds * ns_per_second + fraction;
+}
+
+// Nanoseconds since midnight UTC for epoch nanoseconds (also before 1970)
+constexpr std::int64_t time_of_day_ns(std::int64_t ns) {
+  const auto remainder = ns % ns_per_day;
+  return remainder < 0 ? remainder + ns_per_day : remainder;
+}
+
+// Format epoch nanoseconds as "YYYY-MM-DDTHH:MM:SSZ" (fraction only if non-zero)
+std::string format_timestamp(std::int64_t);
+
+// Compile-time tests for timestamp parsing
+static_assert(parse_timestamp_ns("1970-01-01T00:00:00Z") == 0,
+              "Epoch parses to zero");
+static_assert(parse_timestamp_ns("2024-01-03T14:30:00Z") ==
+                  std::int64_t{1'704'292'200} * ns_per_second,
+              "Bar timestamp parses to epoch ns");
+static_assert(parse_timestamp_ns("2024-01-03T14:30:00.5Z") ==
+                  std::int64_t{1'704'292'200} * ns_per_second + 500'000'000,
+              "Fractional seconds are scaled to ns");
+static_assert(parse_timestamp_ns("2024-01-03T14:30:00.123456789Z") ==
+                  std::int64_t{1'704'292'200} * ns_per_second + 123'456'789,
+              "Nanosecond trade timestamps are exact");
+static_assert(parse_timestamp_ns("2024-02-29T00:00:00Z") >
+                  parse_timestamp_ns("2024-02-28T23:59:59Z"),
+              "Leap day is valid and ordered");
+static_assert(parse_timestamp_ns("2023-02-29T00:00:00Z") == 0,
+              "Invalid dates are rejected");
+static_assert(parse_timestamp_ns("not a timestamp") == 0,
+              "Malformed text is rejected");
+static_assert(time_of_day_ns(parse_timestamp_ns("2024-01-03T14:30:00Z")) ==
+                  14 * ns_per_hour + 30 * ns_per_minute,
+              "Time of day is the offset from midnight UTC");
+static_assert(time_of_day_ns(-ns_per_hour) == 23 * ns_per_hour,
+              "Time of day wraps before the epoch");
@@ -1,12 +1,78 @@
 #include "alpaca_client.h"
+#include "connection_pool.h"
+#include "latency.h"
+#include "rate_limiter.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <ctime>
+#include <exception>
 #include <format>
+#include <iterator>
 #include <httplib.h>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <print>
+#include <utility>
 
 using json = nlohmann::json;
 
+namespace {
+// Symbols per multi-symbol request (keeps the query string well under URL
+// limits for the API)
+constexpr auto max_symbols_per_request = 100uz;
+
+// Account request quota per minute (Alpaca's default)
+constexpr auto default_requests_per_minute = 200.0;
+
+// Requests fan_out keeps in flight (matches the idle connections each
+// ConnectionPool keeps, so a burst reuses warm sockets)
+constexpr auto max_requests_in_flight = 8uz;
+
+// Starting quota for each host from ALPACA_RATE_LIMIT if set, else the
+// default; each host's limiter adopts the X-RateLimit-Limit it reports
+double requests_per_minute() {
+  if (const auto *val = std::getenv("ALPACA_RATE_LIMIT"))
+    if (const auto quota = std::strtod(val, nullptr); quota > 0.0)
+      return quota;
+  return default_requests_per_minute;
+}
+
+// Start and end dates (YYYY-MM-DD, UTC) covering the last N days
+std::pair<std::string, std::string> date_range(int days) {
+  const auto now = std::chrono::system_clock::now();
+  const auto start = now - std::chrono::hours(24 * days);
+
+  const auto end_t = std::chrono::system_clock::to_time_t(now);
+  const auto start_t = std::chrono::system_clock::to_time_t(start);
+
+  auto end_tm = *std::gmtime(&end_t);
+  auto start_tm = *std::gmtime(&start_t);
+
+  return {std::format("{:04}-{:02}-{:02}", start_tm.tm_year + 1900,
+                      start_tm.tm_mon + 1, start_tm.tm_mday),
+          std::format("{:04}-{:02}-{:02}", end_tm.tm_year + 1900,
+                      end_tm.tm_mon + 1, end_tm.tm_mday)};
+}
+
+// Percent-encode a query parameter value (page tokens are base64)
+std::string url_encode(std::string_view value) {
+  auto encoded = std::string{};
+  for (const auto c : value) {
+    if (std::isalnum(static_cast<unsigned char>(c)) or c == '-' or c == '_' or
+        c == '.' or c == '~')
+      encoded += c;
+    else
+      encoded += std::format("%{:02X}", static_cast<unsigned char>(c));
+  }
+  return encoded;
+}
+} // namespace
+
 AlpacaClient::AlpacaClient()
     : api_key_{get_env_or_default("ALPACA_API_KEY", "")},
       api_secret_{get_env_or_default("ALPACA_API_SECRET", "")},
@@ -16,7 +82,18 @@ AlpacaClient::AlpacaClient()
           get_env_or_default("ALPACA_DATA_URL", "https://data.alpaca.markets")},
       data_api_key_{get_env_or_default("ALPACA_DATA_API_KEY", api_key_)},
       data_api_secret_{
-          get_env_or_default("ALPACA_DATA_API_SECRET", api_secret_)} {
+          get_env_or_default("ALPACA_DATA_API_SECRET", api_secret_)},
+      trading_limiter_{std::make_unique<RateLimiter>(requests_per_minute())},
+      data_limiter_{std::make_unique<RateLimiter>(requests_per_minute())},
+      trading_pool_{
+          std::make_unique<ConnectionPool>(base_url_, *trading_limiter_)},
+      data_pool_{std::make_unique<ConnectionPool>(data_url_, *data_limiter_)},
+      // Never more in flight than either limiter would let out back to back
+      request_pool_{std::make_unique<ThreadPool>(std::max(
+          std::min({max_requests_in_flight, trading_limiter_->burst(),
+                    data_limiter_->burst()}) -
+              1,
+          1uz))} {
   // Validate required credentials
   if (api_key_.empty() or api_secret_.empty()) {
     std::println("❌ ERROR: ALPACA_API_KEY and ALPACA_API_SECRET must be set");
@@ -27,6 +104,70 @@ AlpacaClient::AlpacaClient()
   }
 }
 
+AlpacaClient::~AlpacaClient() = default;
+
+std::size_t AlpacaClient::max_concurrent_requests() const {
+  return request_pool_->size() + 1;
+}
+
+void AlpacaClient::run_concurrent(
+    std::size_t count, const std::function<void(std::size_t)> &request) {
+  if (count == 0)
+    return;
+
+  // Workers and the caller claim indices until none are left, so a batch
+  // finishes even if every worker is busy (e.g. on an enclosing batch)
+  struct Batch {
+    std::atomic<std::size_t> next{};
+    std::size_t count{};
+    const std::function<void(std::size_t)> *request{};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t done{};
+    std::exception_ptr error;
+  };
+
+  const auto work = [](Batch &batch) {
+    for (auto i = batch.next++; i < batch.count; i = batch.next++) {
+      auto error = std::exception_ptr{};
+      try {
+        (*batch.request)(i);
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      auto lock = std::lock_guard{batch.mutex};
+      if (error and not batch.error)
+        batch.error = error;
+      if (++batch.done == batch.count)
+        batch.cv.notify_all();
+    }
+  };
+
+  // Shared with the workers, which may only start after the batch is done
+  auto batch = std::make_shared<Batch>();
+  batch->count = count;
+  batch->request = &request;
+
+  const auto helpers = std::min(count, request_pool_->size() + 1) - 1;
+  for (auto i = 0uz; i < helpers; ++i)
+    request_pool_->submit([batch, work] { work(*batch); });
+  work(*batch);
+
+  auto lock = std::unique_lock{batch->mutex};
+  batch->cv.wait(lock, [&] { return batch->done == batch->count; });
+  if (batch->error)
+    std::rethrow_exception(batch->error);
+}
+
+ConnectionStats AlpacaClient::trading_connection_stats() const {
+  return trading_pool_->stats();
+}
+
+ConnectionStats AlpacaClient::data_connection_stats() const {
+  return data_pool_->stats();
+}
+
 std::string AlpacaClient::get_env_or_default(std::string_view name,
                                              std::string_view default_val) {
   if (const auto *val = std::getenv(name.data()))
@@ -36,81 +177,59 @@ std::string AlpacaClient::get_env_or_default(std::string_view name,
 
 std::expected<std::map<std::string, Snapshot>, AlpacaError>
 AlpacaClient::get_snapshots(const std::vector<std::string> &symbols) {
+  static auto &latency = latency_histogram("alpaca.get_snapshots");
+  const auto timer = ScopedTimer{latency};
+
+  // Whole watchlists are split into a few requests to stay inside the API's
+  // symbol and URL length limits, then merged into one map
+  auto snapshots = std::map<std::string, Snapshot>{};
+
+  for (auto first = 0uz; first < symbols.size();
+       first += max_symbols_per_request) {
+    const auto last = std::min(first + max_symbols_per_request, symbols.size());
+
+    // Build comma-separated symbol list
+    auto symbol_list = std::string{};
+    for (auto i = first; i < last; ++i) {
+      if (i > first)
+        symbol_list += ",";
+      symbol_list += symbols[i];
+    }
 
-  // Build comma-separated symbol list
-  auto symbol_list = std::string{};
-  for (auto i = 0uz; i < symbols.size(); ++i) {
-    if (i > 0)
-      symbol_list += ",";
-    symbol_list += symbols[i];
-  }
-
-  // Create HTTPS client for market data API
-  auto client = httplib::Client{data_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(30);
-
-  // Build request path
-  auto path = std::format("/v2/stocks/snapshots?symbols={}", symbol_list);
-
-  // Set headers
-  httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
-                              {"APCA-API-SECRET-KEY", api_secret_}};
-
-  auto res = client.Get(path, headers);
-
-  if (not res) {
-    std::println(stderr, "  Network error - no response");
-    return std::unexpected(AlpacaError::NetworkError);
-  }
-
-  if (res->status == 401)
-    return std::unexpected(AlpacaError::AuthError);
-
-  if (res->status == 429)
-    return std::unexpected(AlpacaError::RateLimitError);
-
-  if (res->status != 200) {
-    // Debug: print error response
-    std::println(stderr, "Snapshots API error: status={}, body={}", res->status,
-                 res->body);
-    return std::unexpected(AlpacaError::UnknownError);
-  }
-
-  try {
-    auto j = json::parse(res->body);
-
-    auto snapshots = std::map<std::string, Snapshot>{};
+    // Build request path
+    auto path = std::format("/v2/stocks/snapshots?symbols={}", symbol_list);
 
-    for (const auto &[symbol, data] : j.items()) {
-      auto snap = Snapshot{};
-      snap.symbol = symbol;
+    // Set headers
+    httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
+                                {"APCA-API-SECRET-KEY", api_secret_}};
 
-      if (data.contains("latestTrade") and not data["latestTrade"].is_null()) {
-        snap.latest_trade_price = data["latestTrade"]["p"];
-        snap.latest_trade_timestamp = data["latestTrade"]["t"];
-      }
+    auto res = data_pool_->get(path, headers, {10, 30});
 
-      if (data.contains("latestQuote") and not data["latestQuote"].is_null()) {
-        snap.latest_quote_bid = data["latestQuote"]["bp"];
-        snap.latest_quote_ask = data["latestQuote"]["ap"];
-      }
+    if (not res) {
+      std::println(stderr, "  Network error - no response");
+      return std::unexpected(AlpacaError::NetworkError);
+    }
 
-      if (data.contains("prevDailyBar") and not data["prevDailyBar"].is_null())
-        snap.prev_daily_bar_close = data["prevDailyBar"]["c"];
+    if (res->status == 401)
+      return std::unexpected(AlpacaError::AuthError);
 
-      // Extract volume from minute bar for volume filtering
-      if (data.contains("minuteBar") and not data["minuteBar"].is_null())
-        snap.minute_bar_volume = data["minuteBar"]["v"];
+    if (res->status == 429)
+      return std::unexpected(AlpacaError::RateLimitError);
 
-      snapshots[symbol] = snap;
+    if (res->status != 200) {
+      // Debug: print error response
+      std::println(stderr, "Snapshots API error: status={}, body={}",
+                   res->status, res->body);
+      return std::unexpected(AlpacaError::UnknownError);
     }
 
-    return snapshots;
-
-  } catch (const json::exception &) {
-    return std::unexpected(AlpacaError::ParseError);
+    auto chunk = parse_snapshots(res->body);
+    if (not chunk)
+      return std::unexpected(chunk.error());
+    snapshots.merge(*chunk);
   }
+
+  return snapshots;
 }
 
 std::optional<Snapshot> AlpacaClient::get_snapshot(std::string_view symbol) {
@@ -127,6 +246,8 @@ std::optional<Snapshot> AlpacaClient::get_snapshot(std::string_view symbol) {
 
 std::expected<std::map<std::string, Snapshot>, AlpacaError>
 AlpacaClient::get_crypto_snapshots(const std::vector<std::string> &symbols) {
+  static auto &latency = latency_histogram("alpaca.get_crypto_snapshots");
+  const auto timer = ScopedTimer{latency};
 
   // Build comma-separated symbol list
   auto symbol_list = std::string{};
@@ -136,11 +257,6 @@ AlpacaClient::get_crypto_snapshots(const std::vector<std::string> &symbols) {
     symbol_list += symbols[i];
   }
 
-  // Create HTTPS client for market data API
-  auto client = httplib::Client{data_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(30);
-
   // Build request path for crypto (v1beta3)
   auto path =
       std::format("/v1beta3/crypto/us/snapshots?symbols={}", symbol_list);
@@ -149,7 +265,7 @@ AlpacaClient::get_crypto_snapshots(const std::vector<std::string> &symbols) {
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_}};
 
-  auto res = client.Get(path, headers);
+  auto res = data_pool_->get(path, headers, {10, 30});
 
   if (not res) {
     std::println(stderr, "  Network error - no response");
@@ -169,57 +285,16 @@ AlpacaClient::get_crypto_snapshots(const std::vector<std::string> &symbols) {
     return std::unexpected(AlpacaError::UnknownError);
   }
 
-  try {
-    auto j = json::parse(res->body);
-
-    auto snapshots = std::map<std::string, Snapshot>{};
-
-    // Crypto response has "snapshots" object containing symbol data
-    if (j.contains("snapshots")) {
-      for (const auto &[symbol, data] : j["snapshots"].items()) {
-        auto snap = Snapshot{};
-        snap.symbol = symbol;
-
-        if (data.contains("latestTrade") and
-            not data["latestTrade"].is_null()) {
-          snap.latest_trade_price = data["latestTrade"]["p"];
-          snap.latest_trade_timestamp = data["latestTrade"]["t"];
-        }
-
-        if (data.contains("latestQuote") and
-            not data["latestQuote"].is_null()) {
-          snap.latest_quote_bid = data["latestQuote"]["bp"];
-          snap.latest_quote_ask = data["latestQuote"]["ap"];
-        }
-
-        if (data.contains("prevDailyBar") and
-            not data["prevDailyBar"].is_null())
-          snap.prev_daily_bar_close = data["prevDailyBar"]["c"];
-
-        // Extract volume from minute bar for volume filtering
-        if (data.contains("minuteBar") and not data["minuteBar"].is_null())
-          snap.minute_bar_volume = data["minuteBar"]["v"];
-
-        snapshots[symbol] = snap;
-      }
-    }
-
-    return snapshots;
-
-  } catch (const json::exception &) {
-    return std::unexpected(AlpacaError::ParseError);
-  }
+  return parse_crypto_snapshots(res->body);
 }
 
 std::expected<std::string, AlpacaError> AlpacaClient::get_account() {
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(30);
-
+  static auto &latency = latency_histogram("alpaca.get_account");
+  const auto timer = ScopedTimer{latency};
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_}};
 
-  auto res = client.Get("/v2/account", headers);
+  auto res = trading_pool_->get("/v2/account", headers, {10, 30});
 
   if (not res)
     return std::unexpected(AlpacaError::NetworkError);
@@ -237,14 +312,12 @@ std::expected<std::string, AlpacaError> AlpacaClient::get_account() {
 }
 
 std::vector<Position> AlpacaClient::get_positions() {
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(30);
-
+  static auto &latency = latency_histogram("alpaca.get_positions");
+  const auto timer = ScopedTimer{latency};
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_}};
 
-  auto res = client.Get("/v2/positions", headers);
+  auto res = trading_pool_->get("/v2/positions", headers, {10, 30});
 
   if (not res or res->status != 200)
     return {};
@@ -270,14 +343,12 @@ std::vector<Position> AlpacaClient::get_positions() {
 }
 
 std::expected<std::string, AlpacaError> AlpacaClient::get_open_orders() {
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(30);
-
+  static auto &latency = latency_histogram("alpaca.get_open_orders");
+  const auto timer = ScopedTimer{latency};
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_}};
 
-  auto res = client.Get("/v2/orders?status=open", headers);
+  auto res = trading_pool_->get("/v2/orders?status=open", headers, {10, 30});
 
   if (not res)
     return std::unexpected(AlpacaError::NetworkError);
@@ -295,15 +366,15 @@ std::expected<std::string, AlpacaError> AlpacaClient::get_open_orders() {
 }
 
 std::expected<std::string, AlpacaError> AlpacaClient::get_all_orders() {
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(30); // Longer timeout for potentially large response
-  client.set_read_timeout(60); // Large response may take time
-
+  static auto &latency = latency_histogram("alpaca.get_all_orders");
+  const auto timer = ScopedTimer{latency};
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_}};
 
   // Get all orders (limit=100 - enough for position recovery and cooldown)
-  auto res = client.Get("/v2/orders?status=all&limit=100", headers);
+  // Longer timeouts as the response is potentially large
+  auto res =
+      trading_pool_->get("/v2/orders?status=all&limit=100", headers, {30, 60});
 
   if (not res)
     return std::unexpected(AlpacaError::NetworkError);
@@ -323,10 +394,8 @@ std::expected<std::string, AlpacaError> AlpacaClient::get_all_orders() {
 std::expected<std::string, AlpacaError>
 AlpacaClient::place_order(std::string_view symbol, std::string_view side,
                           double notional, std::string_view client_order_id) {
-
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(15); // Fail fast for order placement
+  static auto &latency = latency_histogram("alpaca.place_order");
+  const auto timer = ScopedTimer{latency};
 
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_},
@@ -347,8 +416,9 @@ AlpacaClient::place_order(std::string_view symbol, std::string_view side,
   if (not client_order_id.empty())
     order["client_order_id"] = client_order_id;
 
-  auto res =
-      client.Post("/v2/orders", headers, order.dump(), "application/json");
+  // Fail fast for order placement
+  auto res = trading_pool_->post("/v2/orders", headers, order.dump(),
+                                 "application/json", {10, 15});
 
   if (not res)
     return std::unexpected(AlpacaError::NetworkError);
@@ -374,10 +444,8 @@ AlpacaClient::place_order(std::string_view symbol, std::string_view side,
 std::expected<std::string, AlpacaError>
 AlpacaClient::place_order_qty(std::string_view symbol, std::string_view side,
                               double quantity, std::string_view client_order_id) {
-
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(15); // Fail fast for order placement
+  static auto &latency = latency_histogram("alpaca.place_order_qty");
+  const auto timer = ScopedTimer{latency};
 
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_},
@@ -398,8 +466,9 @@ AlpacaClient::place_order_qty(std::string_view symbol, std::string_view side,
   if (not client_order_id.empty())
     order["client_order_id"] = client_order_id;
 
-  auto res =
-      client.Post("/v2/orders", headers, order.dump(), "application/json");
+  // Fail fast for order placement
+  auto res = trading_pool_->post("/v2/orders", headers, order.dump(),
+                                 "application/json", {10, 15});
 
   if (not res)
     return std::unexpected(AlpacaError::NetworkError);
@@ -424,15 +493,13 @@ AlpacaClient::place_order_qty(std::string_view symbol, std::string_view side,
 
 std::expected<std::string, AlpacaError>
 AlpacaClient::close_position(std::string_view symbol) {
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(15); // Fail fast for position closing
-
+  static auto &latency = latency_histogram("alpaca.close_position");
+  const auto timer = ScopedTimer{latency};
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_}};
 
   auto path = std::format("/v2/positions/{}", symbol);
-  auto res = client.Delete(path, headers);
+  auto res = trading_pool_->del(path, headers, {10, 15}); // Fail fast
 
   if (not res)
     return std::unexpected(AlpacaError::NetworkError);
@@ -454,23 +521,24 @@ AlpacaClient::close_position(std::string_view symbol) {
   return res->body;
 }
 
-std::expected<std::vector<Bar>, AlpacaError>
-AlpacaClient::get_bars(std::string_view symbol, std::string_view timeframe,
-                       std::string_view start, std::string_view end) {
-
-  auto client = httplib::Client{data_url_};
-  client.set_connection_timeout(30);
-  client.set_read_timeout(60); // Historical data can be large
+std::expected<BarPage, AlpacaError>
+AlpacaClient::get_bars_page(std::string_view symbol, std::string_view timeframe,
+                            std::string_view start, std::string_view end,
+                            std::string_view page_token, std::size_t limit) {
+  static auto &latency = latency_histogram("alpaca.get_bars_page");
+  const auto timer = ScopedTimer{latency};
 
   // Build request path for stock bars (using IEX feed for free tier)
   auto path = std::format(
-      "/v2/stocks/{}/bars?timeframe={}&start={}&end={}&limit=10000&feed=iex",
-      symbol, timeframe, start, end);
+      "/v2/stocks/{}/bars?timeframe={}&start={}&end={}&limit={}&feed=iex",
+      symbol, timeframe, start, end, limit);
+  if (not page_token.empty())
+    path += "&page_token=" + url_encode(page_token);
 
   httplib::Headers headers = {{"APCA-API-KEY-ID", data_api_key_},
                               {"APCA-API-SECRET-KEY", data_api_secret_}};
 
-  auto res = client.Get(path, headers);
+  auto res = data_pool_->get(path, headers, {30, 60}); // Can be large
 
   if (not res)
     return std::unexpected(AlpacaError::NetworkError);
@@ -481,28 +549,28 @@ AlpacaClient::get_bars(std::string_view symbol, std::string_view timeframe,
   if (res->status == 404)
     return std::unexpected(AlpacaError::InvalidSymbol);
 
+  if (res->status == 429)
+    return std::unexpected(AlpacaError::RateLimitError);
+
   if (res->status != 200)
     return std::unexpected(AlpacaError::UnknownError);
 
-  // Parse bars from response
-  auto data_result = json::parse(res->body, nullptr, false);
-  if (data_result.is_discarded())
-    return std::unexpected(AlpacaError::ParseError);
+  return parse_bars_page(res->body);
+}
 
+std::expected<std::vector<Bar>, AlpacaError>
+AlpacaClient::get_bars(std::string_view symbol, std::string_view timeframe,
+                       std::string_view start, std::string_view end) {
+
+  // Follow every page so long lookbacks aren't silently truncated
   auto bars = std::vector<Bar>{};
-  if (not data_result.contains("bars"))
-    return bars;
-
-  for (const auto &bar_json : data_result["bars"]) {
-    auto bar = Bar{};
-    bar.timestamp = bar_json["t"].get<std::string>();
-    bar.open = bar_json["o"].get<double>();
-    bar.high = bar_json["h"].get<double>();
-    bar.low = bar_json["l"].get<double>();
-    bar.close = bar_json["c"].get<double>();
-    bar.volume = bar_json["v"].get<long>();
-    bars.push_back(bar);
-  }
+  auto reader = BarPageReader{*this, symbol, timeframe, start, end};
+
+  for (const auto &page : reader)
+    bars.insert(bars.end(), page.begin(), page.end());
+
+  if (reader.error())
+    return std::unexpected(*reader.error());
 
   return bars;
 }
@@ -510,20 +578,7 @@ AlpacaClient::get_bars(std::string_view symbol, std::string_view timeframe,
 std::optional<std::vector<Bar>> AlpacaClient::get_bars(std::string_view symbol,
                                                         std::string_view timeframe,
                                                         int days) {
-  // Calculate start and end dates
-  const auto now = std::chrono::system_clock::now();
-  const auto start = now - std::chrono::hours(24 * days);
-
-  const auto end_t = std::chrono::system_clock::to_time_t(now);
-  const auto start_t = std::chrono::system_clock::to_time_t(start);
-
-  auto end_tm = *std::gmtime(&end_t);
-  auto start_tm = *std::gmtime(&start_t);
-
-  const auto end_str = std::format("{:04}-{:02}-{:02}", end_tm.tm_year + 1900,
-                                    end_tm.tm_mon + 1, end_tm.tm_mday);
-  const auto start_str = std::format("{:04}-{:02}-{:02}", start_tm.tm_year + 1900,
-                                      start_tm.tm_mon + 1, start_tm.tm_mday);
+  const auto [start_str, end_str] = date_range(days);
 
   auto result = get_bars(symbol, timeframe, start_str, end_str);
   if (not result)
@@ -532,68 +587,126 @@ std::optional<std::vector<Bar>> AlpacaClient::get_bars(std::string_view symbol,
   return result.value();
 }
 
-std::expected<std::vector<Bar>, AlpacaError>
-AlpacaClient::get_crypto_bars(std::string_view symbol,
-                              std::string_view timeframe,
-                              std::string_view start, std::string_view end) {
+std::expected<std::map<std::string, std::vector<Bar>>, AlpacaError>
+AlpacaClient::get_multi_bars(const std::vector<std::string> &symbols,
+                             std::string_view timeframe,
+                             std::string_view start, std::string_view end) {
+  static auto &latency = latency_histogram("alpaca.get_multi_bars");
+  const auto timer = ScopedTimer{latency};
+
+  auto all_bars = std::map<std::string, std::vector<Bar>>{};
+
+  for (auto first = 0uz; first < symbols.size();
+       first += max_symbols_per_request) {
+    const auto last = std::min(first + max_symbols_per_request, symbols.size());
+
+    // Build comma-separated symbol list
+    auto symbol_list = std::string{};
+    for (auto i = first; i < last; ++i) {
+      if (i > first)
+        symbol_list += ",";
+      symbol_list += symbols[i];
+    }
 
-  auto client = httplib::Client{data_url_};
-  client.set_connection_timeout(30);
-  client.set_read_timeout(60); // Historical data can be large
+    const auto path =
+        std::format("/v2/stocks/bars?symbols={}&timeframe={}&start={}"
+                    "&end={}&limit=10000&feed=iex",
+                    symbol_list, timeframe, start, end);
+    if (auto read = read_multi_bars_pages(path, all_bars); not read)
+      return std::unexpected(read.error());
+  }
 
-  // Build request path for crypto bars
-  auto path =
-      std::format("/v1beta3/crypto/us/"
-                  "bars?symbols={}&timeframe={}&start={}&end={}&limit=10000",
-                  symbol, timeframe, start, end);
+  return all_bars;
+}
 
+std::expected<void, AlpacaError> AlpacaClient::read_multi_bars_pages(
+    std::string_view base_path,
+    std::map<std::string, std::vector<Bar>> &all_bars) {
   httplib::Headers headers = {{"APCA-API-KEY-ID", data_api_key_},
                               {"APCA-API-SECRET-KEY", data_api_secret_}};
 
-  auto res = client.Get(path, headers);
+  // The limit applies across all symbols in the request, so keep following
+  // next_page_token until the whole range has been returned
+  auto page_token = std::string{};
+  do {
+    auto path = std::string{base_path};
+    if (not page_token.empty())
+      path += "&page_token=" + url_encode(page_token);
 
-  if (not res)
-    return std::unexpected(AlpacaError::NetworkError);
+    auto res = data_pool_->get(path, headers, {30, 60}); // Can be large
 
-  if (res->status == 401)
-    return std::unexpected(AlpacaError::AuthError);
+    if (not res)
+      return std::unexpected(AlpacaError::NetworkError);
 
-  if (res->status == 404)
-    return std::unexpected(AlpacaError::InvalidSymbol);
+    if (res->status == 401)
+      return std::unexpected(AlpacaError::AuthError);
 
-  if (res->status != 200)
-    return std::unexpected(AlpacaError::UnknownError);
+    if (res->status == 404)
+      return std::unexpected(AlpacaError::InvalidSymbol);
 
-  // Parse bars from response
-  auto data_result = json::parse(res->body, nullptr, false);
-  if (data_result.is_discarded())
-    return std::unexpected(AlpacaError::ParseError);
+    if (res->status == 429)
+      return std::unexpected(AlpacaError::RateLimitError);
 
-  auto bars = std::vector<Bar>{};
-  if (not data_result.contains("bars") or
-      not data_result["bars"].contains(std::string{symbol}))
-    return bars;
-
-  for (const auto &bar_json : data_result["bars"][std::string{symbol}]) {
-    auto bar = Bar{};
-    bar.timestamp = bar_json["t"].get<std::string>();
-    bar.open = bar_json["o"].get<double>();
-    bar.high = bar_json["h"].get<double>();
-    bar.low = bar_json["l"].get<double>();
-    bar.close = bar_json["c"].get<double>();
-    bar.volume = bar_json["v"].get<long>();
-    bars.push_back(bar);
-  }
+    if (res->status != 200) {
+      std::println(stderr, "Multi-bars API error: status={}, body={}",
+                   res->status, res->body);
+      return std::unexpected(AlpacaError::UnknownError);
+    }
 
-  return bars;
+    auto page = parse_multi_bars_page(res->body);
+    if (not page)
+      return std::unexpected(page.error());
+
+    for (auto &[symbol, bars] : page->bars) {
+      auto &all = all_bars[symbol];
+      all.insert(all.end(), std::make_move_iterator(bars.begin()),
+                 std::make_move_iterator(bars.end()));
+    }
+
+    page_token = std::move(page->next_page_token);
+  } while (not page_token.empty());
+
+  return {};
 }
 
-std::expected<MarketClock, AlpacaError> AlpacaClient::get_market_clock() {
-  // Create HTTPS client for trading API
-  auto client = httplib::Client{base_url_};
-  client.set_connection_timeout(10);
-  client.set_read_timeout(30);
+std::optional<std::map<std::string, std::vector<Bar>>>
+AlpacaClient::get_multi_bars(const std::vector<std::string> &symbols,
+                             std::string_view timeframe, int days) {
+  const auto [start_str, end_str] = date_range(days);
+
+  auto result = get_multi_bars(symbols, timeframe, start_str, end_str);
+  if (not result)
+    return std::nullopt;
 
+  return result.value();
+}
+
+std::expected<std::vector<Bar>, AlpacaError>
+AlpacaClient::get_crypto_bars(std::string_view symbol,
+                              std::string_view timeframe,
+                              std::string_view start, std::string_view end) {
+  static auto &latency = latency_histogram("alpaca.get_crypto_bars");
+  const auto timer = ScopedTimer{latency};
+
+  // Same layout and paging as the multi-symbol stock bars endpoint
+  const auto path =
+      std::format("/v1beta3/crypto/us/"
+                  "bars?symbols={}&timeframe={}&start={}&end={}&limit=10000",
+                  symbol, timeframe, start, end);
+
+  auto all_bars = std::map<std::string, std::vector<Bar>>{};
+  if (auto read = read_multi_bars_pages(path, all_bars); not read)
+    return std::unexpected(read.error());
+
+  auto bars = all_bars.find(std::string{symbol});
+  if (bars == all_bars.end())
+    return std::vector<Bar>{};
+  return std::move(bars->second);
+}
+
+std::expected<MarketClock, AlpacaError> AlpacaClient::get_market_clock() {
+  static auto &latency = latency_histogram("alpaca.get_market_clock");
+  const auto timer = ScopedTimer{latency};
   // Build request path
   const auto path = std::string{"/v2/clock"};
 
@@ -601,7 +714,7 @@ std::expected<MarketClock, AlpacaError> AlpacaClient::get_market_clock() {
   httplib::Headers headers = {{"APCA-API-KEY-ID", api_key_},
                               {"APCA-API-SECRET-KEY", api_secret_}};
 
-  auto res = client.Get(path, headers);
+  auto res = trading_pool_->get(path, headers, {10, 30});
 
   if (not res) {
     std::println(stderr, "  Network error - no response from clock API");
@@ -636,3 +749,51 @@ std::expected<MarketClock, AlpacaError> AlpacaClient::get_market_clock() {
     return std::unexpected(AlpacaError::ParseError);
   }
 }
+
+// BarPageReader implementation
+
+BarPageReader::BarPageReader(AlpacaClient &client, std::string_view symbol,
+                             std::string_view timeframe,
+                             std::string_view start, std::string_view end,
+                             std::size_t page_size)
+    : client_{client}, symbol_{symbol}, timeframe_{timeframe}, start_{start},
+      end_{end}, page_size_{page_size} {}
+
+std::expected<std::vector<Bar>, AlpacaError> BarPageReader::next() {
+  if (done_)
+    return std::vector<Bar>{};
+
+  auto page = client_.get_bars_page(symbol_, timeframe_, start_, end_,
+                                    page_token_, page_size_);
+  if (not page) {
+    done_ = true;
+    error_ = page.error();
+    return std::unexpected(page.error());
+  }
+
+  page_token_ = std::move(page->next_page_token);
+  done_ = page_token_.empty();
+
+  return std::move(page->bars);
+}
+
+BarPageReader::iterator &BarPageReader::iterator::operator++() {
+  if (reader_->done()) {
+    reader_ = nullptr;
+    return *this;
+  }
+
+  // Errors end the iteration; callers check BarPageReader::error() afterwards
+  auto page = reader_->next();
+  if (not page or page->empty())
+    reader_ = nullptr;
+  else
+    page_ = std::move(*page);
+
+  return *this;
+}
+
+BarPageReader::iterator BarPageReader::begin() {
+  auto it = iterator{this};
+  return ++it;
+}
@@ -0,0 +1,326 @@
+// Streaming decoders for Alpaca's bars and snapshots response bodies
+// nlohmann's SAX parser reports each token as it is read; the handlers below
+// track just enough nesting to write fields straight into Bars and Snapshots,
+// so no DOM is built; timestamps are parsed to epoch ns as they arrive
+
+#include "alpaca_client.h"
+#include "latency.h"
+#include "timestamps.h"
+#include <nlohmann/json.hpp>
+#include <utility>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Accepts every token; handlers override the events they care about
+struct IgnoreAll {
+  bool null() { return true; }
+  bool boolean(bool) { return true; }
+  bool number_integer(json::number_integer_t) { return true; }
+  bool number_unsigned(json::number_unsigned_t) { return true; }
+  bool number_float(json::number_float_t, const json::string_t &) {
+    return true;
+  }
+  bool string(json::string_t &) { return true; }
+  bool binary(json::binary_t &) { return true; }
+  bool start_object(std::size_t) { return true; }
+  bool end_object() { return true; }
+  bool start_array(std::size_t) { return true; }
+  bool end_array() { return true; }
+  bool key(json::string_t &) { return true; }
+  bool parse_error(std::size_t, const std::string &,
+                   const json::exception &) {
+    return false;
+  }
+};
+
+// Bars in either layout, with depths counted from 1 inside the root object:
+//   single symbol: {"bars": [{bar}, ...], "next_page_token": ...}
+//   multi symbol:  {"bars": {"AAPL": [{bar}, ...]}, "next_page_token": ...}
+// Bar objects sit at depth 3 (single) or 4 (multi)
+class BarsHandler : public IgnoreAll {
+public:
+  BarPage single;
+  MultiBarPage multi;
+
+  // Room for the bars a single-symbol body holds (one "t" key per bar), so
+  // the page is filled without regrowing
+  void reserve_single(std::string_view body) {
+    auto count = 0uz;
+    for (auto pos = body.find(R"("t":)"); pos != std::string_view::npos;
+         pos = body.find(R"("t":)", pos + 4))
+      ++count;
+    single.bars.reserve(count);
+  }
+
+  bool start_object(std::size_t) {
+    ++depth_;
+    if (in_bars_ and depth_ == 2)
+      bar_depth_ = 4; // Keyed by symbol
+    else if (series_ and depth_ == bar_depth_) {
+      bar_ = &series_->emplace_back();
+      field_ = 0;
+    }
+    return true;
+  }
+
+  bool end_object() {
+    if (depth_ == bar_depth_)
+      bar_ = nullptr;
+    --depth_;
+    return true;
+  }
+
+  bool start_array(std::size_t) {
+    ++depth_;
+    if (in_bars_ and depth_ == 2) {
+      series_ = &single.bars;
+      bar_depth_ = 3;
+    } else if (in_bars_ and depth_ == 3 and bar_depth_ == 4) {
+      series_ = &multi.bars[symbol_];
+    }
+    return true;
+  }
+
+  bool end_array() {
+    if (depth_ == bar_depth_ - 1)
+      series_ = nullptr;
+    --depth_;
+    return true;
+  }
+
+  bool key(json::string_t &key) {
+    if (depth_ == 1) {
+      in_bars_ = key == "bars";
+      in_token_ = key == "next_page_token";
+    } else if (in_bars_ and depth_ == 2 and bar_depth_ == 4) {
+      symbol_ = std::move(key);
+    } else if (bar_ and depth_ == bar_depth_) {
+      field_ = key.size() == 1 ? key[0] : 0;
+    }
+    return true;
+  }
+
+  bool string(json::string_t &value) {
+    if (bar_ and depth_ == bar_depth_ and field_ == 't')
+      bar_->timestamp = parse_timestamp_ns(value);
+    else if (depth_ == 1 and in_token_)
+      single.next_page_token = multi.next_page_token = value;
+    return true;
+  }
+
+  bool number_float(json::number_float_t value, const json::string_t &) {
+    number(value);
+    return true;
+  }
+  bool number_integer(json::number_integer_t value) {
+    number(static_cast<double>(value));
+    return true;
+  }
+  bool number_unsigned(json::number_unsigned_t value) {
+    number(static_cast<double>(value));
+    return true;
+  }
+
+private:
+  void number(double value) {
+    if (not bar_ or depth_ != bar_depth_)
+      return;
+    switch (field_) {
+    case 'o':
+      bar_->open = value;
+      break;
+    case 'h':
+      bar_->high = value;
+      break;
+    case 'l':
+      bar_->low = value;
+      break;
+    case 'c':
+      bar_->close = value;
+      break;
+    case 'v':
+      bar_->volume = static_cast<long>(value);
+      break;
+    }
+  }
+
+  std::size_t depth_{};
+  bool in_bars_{};
+  bool in_token_{};
+  std::size_t bar_depth_{};
+  std::string symbol_;
+  std::vector<Bar> *series_{};
+  Bar *bar_{};
+  char field_{}; // Single-letter bar key being read (0 for others)
+};
+
+// Snapshots keyed by symbol, either at the root (stocks) or under a
+// "snapshots" key (crypto):
+//   {"AAPL": {"latestTrade": {"p": ..., "t": ...}, "latestQuote": {...},
+//             "minuteBar": {...}, "prevDailyBar": {...}, ...}, ...}
+class SnapshotsHandler : public IgnoreAll {
+public:
+  std::map<std::string, Snapshot> snapshots;
+
+  // Depth of the object keyed by symbol: 1 for stocks, 2 for crypto
+  explicit SnapshotsHandler(std::size_t symbol_depth)
+      : symbol_depth_{symbol_depth}, in_symbols_{symbol_depth == 1} {}
+
+  bool start_object(std::size_t) {
+    ++depth_;
+    return true;
+  }
+
+  bool end_object() {
+    if (depth_ == symbol_depth_ + 1)
+      section_ = Section::Other;
+    else if (depth_ == symbol_depth_)
+      snapshot_ = nullptr;
+    --depth_;
+    return true;
+  }
+
+  bool start_array(std::size_t) {
+    ++depth_;
+    return true;
+  }
+
+  bool end_array() {
+    --depth_;
+    return true;
+  }
+
+  bool key(json::string_t &key) {
+    if (depth_ == symbol_depth_ - 1) {
+      in_symbols_ = key == "snapshots";
+    } else if (depth_ == symbol_depth_ and in_symbols_) {
+      snapshot_ = &snapshots[key];
+      snapshot_->symbol = std::move(key);
+    } else if (snapshot_ and depth_ == symbol_depth_ + 1) {
+      section_ = key == "latestTrade"    ? Section::LatestTrade
+                 : key == "latestQuote"  ? Section::LatestQuote
+                 : key == "minuteBar"    ? Section::MinuteBar
+                 : key == "prevDailyBar" ? Section::PrevDailyBar
+                                         : Section::Other;
+    } else if (section_ != Section::Other and
+               depth_ == symbol_depth_ + 2) {
+      field_ = std::move(key);
+    }
+    return true;
+  }
+
+  bool string(json::string_t &value) {
+    if (in_field() and section_ == Section::LatestTrade and field_ == "t")
+      snapshot_->latest_trade_timestamp = parse_timestamp_ns(value);
+    return true;
+  }
+
+  bool number_float(json::number_float_t value, const json::string_t &) {
+    number(value);
+    return true;
+  }
+  bool number_integer(json::number_integer_t value) {
+    number(static_cast<double>(value));
+    return true;
+  }
+  bool number_unsigned(json::number_unsigned_t value) {
+    number(static_cast<double>(value));
+    return true;
+  }
+
+private:
+  enum class Section {
+    Other,
+    LatestTrade,
+    LatestQuote,
+    MinuteBar,
+    PrevDailyBar
+  };
+
+  bool in_field() const {
+    return snapshot_ and section_ != Section::Other and
+           depth_ == symbol_depth_ + 2;
+  }
+
+  void number(double value) {
+    if (not in_field())
+      return;
+    switch (section_) {
+    case Section::LatestTrade:
+      if (field_ == "p")
+        snapshot_->latest_trade_price = value;
+      break;
+    case Section::LatestQuote:
+      if (field_ == "bp")
+        snapshot_->latest_quote_bid = value;
+      else if (field_ == "ap")
+        snapshot_->latest_quote_ask = value;
+      break;
+    case Section::MinuteBar:
+      if (field_ == "v")
+        snapshot_->minute_bar_volume = static_cast<long>(value);
+      break;
+    case Section::PrevDailyBar:
+      if (field_ == "c")
+        snapshot_->prev_daily_bar_close = value;
+      break;
+    case Section::Other:
+      break;
+    }
+  }
+
+  std::size_t symbol_depth_;
+  std::size_t depth_{};
+  bool in_symbols_;
+  Snapshot *snapshot_{};
+  Section section_{Section::Other};
+  std::string field_;
+};
+
+std::expected<std::map<std::string, Snapshot>, AlpacaError>
+parse_snapshot_map(std::string_view body, std::size_t symbol_depth) {
+  auto handler = SnapshotsHandler{symbol_depth};
+  if (not json::sax_parse(body, &handler))
+    return std::unexpected(AlpacaError::ParseError);
+  return std::move(handler.snapshots);
+}
+
+} // anonymous namespace
+
+std::expected<BarPage, AlpacaError> parse_bars_page(std::string_view body) {
+  static auto &latency = latency_histogram("json.parse_bars_page");
+  const auto timer = ScopedTimer{latency};
+
+  auto handler = BarsHandler{};
+  handler.reserve_single(body);
+  if (not json::sax_parse(body, &handler))
+    return std::unexpected(AlpacaError::ParseError);
+  return std::move(handler.single);
+}
+
+std::expected<MultiBarPage, AlpacaError>
+parse_multi_bars_page(std::string_view body) {
+  static auto &latency = latency_histogram("json.parse_multi_bars_page");
+  const auto timer = ScopedTimer{latency};
+
+  auto handler = BarsHandler{};
+  if (not json::sax_parse(body, &handler))
+    return std::unexpected(AlpacaError::ParseError);
+  return std::move(handler.multi);
+}
+
+std::expected<std::map<std::string, Snapshot>, AlpacaError>
+parse_snapshots(std::string_view body) {
+  static auto &latency = latency_histogram("json.parse_snapshots");
+  const auto timer = ScopedTimer{latency};
+  return parse_snapshot_map(body, 1);
+}
+
+std::expected<std::map<std::string, Snapshot>, AlpacaError>
+parse_crypto_snapshots(std::string_view body) {
+  static auto &latency = latency_histogram("json.parse_crypto_snapshots");
+  const auto timer = ScopedTimer{latency};
+  return parse_snapshot_map(body, 2);
+}
@@ -0,0 +1,288 @@
+// Single-sweep multi-strategy backtest engine
+
+#include "backtest.h"
+#include "cross_section.h"
+#include "defs.h"
+#include "lft.h"
+#include "thread_pool.h"
+#include "timestamps.h"
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <span>
+#include <vector>
+
+namespace {
+
+// One strategy's positions and cash during a backtest
+struct StrategyBook {
+  StrategyStats stats;
+  double cash{};
+  std::map<std::string, BacktestPosition> positions;
+};
+
+// A symbol's state at one bar index, shared by every book
+struct SymbolStep {
+  const Bar *bar{}; // nullptr if the symbol has no bar at this index
+  bool can_enter{}; // Enough history and outside the risk-off period
+  StrategyMask buy_signals; // Strategies signalling a buy (if can_enter)
+};
+
+// Below this many symbol-bars a run finishes faster than its work can be
+// handed to the pool, so every pass runs on the calling thread
+constexpr auto min_parallel_steps = 4096uz;
+
+// Market opens at 14:30 UTC (9:30 AM ET), risk-off until 15:00 UTC (10:00 AM ET)
+// This matches live trading behaviour
+// (bars starting 14:30 through 15:00 inclusive)
+bool is_risk_off_bar(std::int64_t timestamp) {
+  const auto time = time_of_day_ns(timestamp);
+  return time >= 14 * ns_per_hour + 30 * ns_per_minute and
+         time < 15 * ns_per_hour + ns_per_minute;
+}
+
+void close_position(StrategyBook &book, const BacktestPosition &pos,
+                    double exit_price) {
+  const auto pl_dollars = (exit_price - pos.entry_price) * pos.quantity;
+
+  book.cash += exit_price * pos.quantity;
+  ++book.stats.trades_closed;
+
+  if (pl_dollars > 0.0) {
+    ++book.stats.profitable_trades;
+    book.stats.total_profit += pl_dollars;
+  } else {
+    ++book.stats.losing_trades;
+    book.stats.total_loss += pl_dollars;
+  }
+}
+
+// Split [0, count) into one contiguous chunk per pool thread and run
+// f(begin, end) for each: the first on the calling thread, the rest on the
+// pool. Returns once every chunk is done; serial runs every item inline
+template <typename F>
+void parallel_chunks(ThreadPool &pool, std::size_t count, bool serial,
+                     F &&f) {
+  const auto chunk =
+      serial ? count : std::max(1uz, (count + pool.size() - 1) / pool.size());
+  auto pending = std::vector<std::future<void>>{};
+  for (auto begin = chunk; begin < count; begin += chunk)
+    pending.push_back(
+        pool.submit([&f, begin, end = std::min(count, begin + chunk)] {
+          f(begin, end);
+        }));
+  f(0uz, std::min(count, chunk));
+  for (auto &done : pending)
+    done.get();
+}
+
+// Strategies in the mask signalling a buy for a symbol at its latest bar
+StrategyMask buy_signals(const StrategySet &set, const PriceHistory &history,
+                         StrategyMask strategies, const MarketContext &market) {
+  auto signals = StrategyMask{};
+  for_each_strategy([&](auto id) {
+    constexpr auto strategy = decltype(id)::value;
+    if (not strategies.test(strategy))
+      return;
+    const auto signal = set.signal<strategy>(history, market);
+    signals.set(strategy, signal.should_buy and signal.confidence >= 0.7);
+  });
+  return signals;
+}
+
+// Process exits and entries for one book at one bar index
+// steps holds every symbol's step at that index, in symbol order
+void advance_book(StrategyBook &book, StrategyId strategy,
+                  const ExitParams &exit,
+                  std::span<const std::string *const> symbols,
+                  std::span<const SymbolStep> steps, std::size_t bar_idx) {
+  for (auto i = 0uz; i < steps.size(); ++i) {
+    const auto &step = steps[i];
+    if (step.bar == nullptr)
+      continue;
+
+    const auto &symbol = *symbols[i];
+    const auto current_price = step.bar->close;
+
+    // Check exit conditions for existing position
+    if (auto it = book.positions.find(symbol); it != book.positions.end()) {
+      auto &pos = it->second;
+
+      const auto pl_dollars = (current_price - pos.entry_price) * pos.quantity;
+      const auto pl_pct = pl_dollars / (pos.entry_price * pos.quantity);
+
+      // Update peak for trailing stop
+      if (current_price > pos.peak_price)
+        pos.peak_price = current_price;
+
+      const auto should_exit =
+          (pl_pct >= exit.take_profit_pct) or      // Take profit
+          (pl_pct <= -exit.stop_loss_pct) or       // Stop loss
+          (pl_pct <= -exit.panic_stop_loss_pct) or // Panic stop (safety net)
+          (current_price <
+           pos.peak_price * (1.0 - exit.trailing_stop_pct)); // Trailing stop
+
+      if (should_exit) {
+        close_position(book, pos, current_price);
+        book.positions.erase(it);
+      }
+    }
+
+    // Check entry signals (only if no position and enough cash)
+    if (not step.can_enter or book.positions.contains(symbol) or
+        book.cash < notional_amount)
+      continue;
+
+    ++book.stats.signals_generated;
+
+    if (step.buy_signals.test(strategy)) {
+      const auto entry_price = current_price;
+      const auto quantity = notional_amount / entry_price;
+
+      book.positions[symbol] = BacktestPosition{
+          .symbol = symbol,
+          .strategy = std::string{strategy_names[strategy]},
+          .entry_price = entry_price,
+          .quantity = quantity,
+          .entry_bar_index = bar_idx,
+          .peak_price = entry_price,
+      };
+
+      book.cash -= entry_price * quantity;
+      ++book.stats.trades_executed;
+    }
+  }
+}
+
+} // anonymous namespace
+
+BacktestResult
+run_backtest(StrategyMask strategies,
+             const std::map<std::string, std::vector<Bar>> &all_bars,
+             double starting_capital, ThreadPool &pool) {
+  const auto live = ExitParams{};
+  return std::move(run_backtest(strategies, std::span{&live, 1}, all_bars,
+                                starting_capital, pool)
+                       .front());
+}
+
+std::vector<BacktestResult>
+run_backtest(StrategyMask strategies, std::span<const ExitParams> exits,
+             const std::map<std::string, std::vector<Bar>> &all_bars,
+             double starting_capital, ThreadPool &pool) {
+  // One book per (exit params, strategy in the mask)
+  struct Book {
+    StrategyBook state;
+    StrategyId strategy;
+    const ExitParams *exit;
+    BacktestResult *result;
+  };
+
+  auto results = std::vector<BacktestResult>(exits.size());
+  auto books = std::vector<Book>{};
+  books.reserve(exits.size() * strategies.count());
+  for (auto i = 0uz; i < exits.size(); ++i) {
+    for (auto id = 0uz; id < strategy_count; ++id) {
+      results[i][id].name = strategy_names[id];
+      if (strategies.test(id))
+        books.push_back(Book{
+            .state = StrategyBook{.stats = {}, .cash = starting_capital, .positions = {}},
+            .strategy = id,
+            .exit = &exits[i],
+            .result = &results[i],
+        });
+    }
+  }
+
+  // Symbols in map order and the longest series; bar indices are aligned
+  // from each series' first bar
+  auto symbols = std::vector<const std::string *>{};
+  auto series = std::vector<const std::vector<Bar> *>{};
+  auto max_bars = 0uz;
+  for (const auto &[symbol, bars] : all_bars) {
+    symbols.push_back(&symbol);
+    series.push_back(&bars);
+    max_bars = std::max(max_bars, bars.size());
+  }
+  const auto symbol_count = symbols.size();
+  const auto serial = max_bars * symbol_count < min_parallel_steps;
+
+  // The run is split into three passes, each one fork/join over the pool
+  // for the whole history rather than per bar:
+  //   1. each symbol's change percent at every bar index
+  //   2. the market average per bar, then each symbol's strategy state and
+  //      buy signals at every bar index
+  //   3. each book trading through every bar index
+  // Matrices are time-major: entry [bar_idx * symbol_count + symbol]
+
+  // Pass 1. A symbol whose series has ended keeps its last change percent
+  // (1.0 / 0.0 marks whether it has one)
+  auto changes = std::vector<double>(max_bars * symbol_count);
+  auto has_change = std::vector<double>(max_bars * symbol_count);
+  parallel_chunks(pool, symbol_count, serial, [&](auto begin, auto end) {
+    for (auto s = begin; s < end; ++s) {
+      auto history = PriceHistory{};
+      for (auto bar_idx = 0uz; bar_idx < max_bars; ++bar_idx) {
+        if (bar_idx < series[s]->size()) {
+          const auto &bar = (*series[s])[bar_idx];
+          history.add_bar(bar.close, bar.high, bar.low, bar.volume);
+        }
+        changes[bar_idx * symbol_count + s] = history.change_percent;
+        has_change[bar_idx * symbol_count + s] =
+            history.has_history ? 1.0 : 0.0;
+      }
+    }
+  });
+
+  // Shared by every relative_strength evaluation at a bar
+  auto markets = std::vector<MarketContext>(max_bars);
+  for (auto bar_idx = 0uz; bar_idx < max_bars; ++bar_idx) {
+    const auto row = bar_idx * symbol_count;
+    markets[bar_idx].average_change =
+        masked_mean(std::span{changes}.subspan(row, symbol_count),
+                    std::span{has_change}.subspan(row, symbol_count));
+  }
+
+  // Pass 2. Signals are pure functions of the shared state, so each
+  // symbol's are evaluated once however many books consume them
+  auto steps = std::vector<SymbolStep>(max_bars * symbol_count);
+  parallel_chunks(pool, symbol_count, serial, [&](auto begin, auto end) {
+    for (auto s = begin; s < end; ++s) {
+      auto history = PriceHistory{};
+      auto set = StrategySet{};
+      for (auto bar_idx = 0uz; bar_idx < series[s]->size(); ++bar_idx) {
+        const auto &bar = (*series[s])[bar_idx];
+        history.add_bar(bar.close, bar.high, bar.low, bar.volume);
+        set.on_bar(history);
+
+        auto &step = steps[bar_idx * symbol_count + s];
+        step.bar = &bar;
+        step.can_enter = history.prices.size() >= 21 and
+                         not is_risk_off_bar(bar.timestamp);
+        if (step.can_enter)
+          step.buy_signals =
+              buy_signals(set, history, strategies, markets[bar_idx]);
+      }
+    }
+  });
+
+  // Pass 3. Steps are read-only while the books advance
+  parallel_chunks(pool, books.size(), serial, [&](auto begin, auto end) {
+    for (auto i = begin; i < end; ++i)
+      for (auto bar_idx = 0uz; bar_idx < max_bars; ++bar_idx)
+        advance_book(
+            books[i].state, books[i].strategy, *books[i].exit, symbols,
+            std::span{steps}.subspan(bar_idx * symbol_count, symbol_count),
+            bar_idx);
+  });
+
+  // Close any remaining positions at end of history (mark-to-market)
+  for (auto &book : books) {
+    for (const auto &[symbol, pos] : book.state.positions)
+      close_position(book.state, pos, all_bars.at(symbol).back().close);
+    book.state.stats.name = strategy_names[book.strategy];
+    (*book.result)[book.strategy] = std::move(book.state.stats);
+  }
+
+  return results;
+}
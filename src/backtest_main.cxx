@@ -0,0 +1,119 @@
+// Offline backtest
+// Runs calibration (and optionally the exit sweep) on bars already on disk,
+// without API credentials or network access
+//
+// Usage: lft_backtest [--threads N] [--sweep] [--csv DIR] [--export-csv DIR]
+//   --threads N       Backtest threads (default one per core)
+//   --sweep           Also rank exit-threshold combinations (see lft --sweep)
+//   --csv DIR         Load DIR/backtest_bars_<SYMBOL>.csv instead of the
+//                     binary bar cache (cache/bars, written by every lft run)
+//   --export-csv DIR  Convert the loaded bars to CSV files in DIR and exit
+
+#include "bar_csv.h"
+#include "bar_store.h"
+#include "defs.h"
+#include "lft.h"
+#include "timestamps.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Watchlist bars from the binary cache, limited to the calibration window
+// ending at the newest cached bar (what lft would have calibrated on)
+// Files are mapped and only the window's bars are materialised
+std::map<std::string, std::vector<Bar>> load_cached_bars() {
+  const auto store = BarStore{bar_cache_dir};
+  auto series = std::map<std::string, MappedBars>{};
+  auto newest_ns = std::int64_t{};
+
+  for (const auto &symbol : stocks) {
+    auto mapped = store.map(symbol, "15Min");
+    if (mapped.empty())
+      continue;
+    newest_ns = std::max(newest_ns, mapped.timestamps().back());
+    series.emplace(symbol, std::move(mapped));
+  }
+
+  auto all_bars = std::map<std::string, std::vector<Bar>>{};
+  for (const auto &[symbol, mapped] : series) {
+    const auto [first, last] =
+        mapped.range(newest_ns - calibration_days * ns_per_day, newest_ns + 1);
+    all_bars[symbol] = mapped.bars(first, last);
+  }
+
+  return all_bars;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  std::println("🧪 LFT - Offline Backtest");
+
+  auto threads = std::max(1u, std::thread::hardware_concurrency());
+  auto sweep = false;
+  auto csv_dir = std::optional<std::filesystem::path>{};
+  auto export_dir = std::optional<std::filesystem::path>{};
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--threads" and i + 1 < argc) {
+      threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+    } else if (arg == "--sweep") {
+      sweep = true;
+    } else if (arg == "--csv" and i + 1 < argc) {
+      csv_dir = argv[++i];
+    } else if (arg == "--export-csv" and i + 1 < argc) {
+      export_dir = argv[++i];
+    } else {
+      std::println(stderr,
+                   "Usage: {} [--threads N] [--sweep] [--csv DIR] "
+                   "[--export-csv DIR]",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  const auto bars = csv_dir ? read_bars_csv_dir(*csv_dir) : load_cached_bars();
+  const auto source = csv_dir ? csv_dir->string() : std::string{bar_cache_dir};
+
+  if (bars.empty()) {
+    std::println("❌ No bars in {} - run lft once to populate it", source);
+    return 1;
+  }
+
+  auto bar_count = 0uz;
+  for (const auto &[symbol, series] : bars)
+    bar_count += series.size();
+  std::println("📊 Loaded {} bars for {} symbols from {} in {} ms", bar_count,
+               bars.size(), source,
+               std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - started)
+                   .count());
+
+  // Conversion only: binary cache (or CSV) to CSV for offline analysis
+  if (export_dir) {
+    write_bars_csv_dir(*export_dir, bars);
+    return 0;
+  }
+
+  // Same starting capital as live calibration
+  constexpr auto backtest_capital = 100000.0;
+  std::println("🎯 Calibrating strategies with ${:.2f} starting capital...",
+               backtest_capital);
+  calibrate(bars, backtest_capital, threads);
+
+  if (sweep)
+    sweep_exit_params(bars, backtest_capital, threads);
+
+  return 0;
+}
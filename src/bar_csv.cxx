@@ -0,0 +1,98 @@
+#include "bar_csv.h"
+#include "timestamps.h"
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <print>
+#include <string_view>
+
+namespace {
+
+constexpr auto csv_prefix = std::string_view{"backtest_bars_"};
+constexpr auto csv_extension = std::string_view{".csv"};
+
+// Split off the next comma-separated field
+std::string_view next_field(std::string_view &line) {
+  const auto comma = line.find(',');
+  const auto field = line.substr(0, comma);
+  line = comma == std::string_view::npos ? std::string_view{}
+                                         : line.substr(comma + 1);
+  return field;
+}
+
+template <typename T> bool parse_field(std::string_view &line, T &value) {
+  const auto field = next_field(line);
+  const auto [end, ec] =
+      std::from_chars(field.data(), field.data() + field.size(), value);
+  return ec == std::errc{} and end == field.data() + field.size();
+}
+
+} // anonymous namespace
+
+std::vector<Bar> read_bars_csv(const std::filesystem::path &path) {
+  auto file = std::ifstream{path};
+  auto bars = std::vector<Bar>{};
+
+  auto text = std::string{};
+  std::getline(file, text); // Header
+  while (std::getline(file, text)) {
+    auto line = std::string_view{text};
+    if (not line.empty() and line.back() == '\r')
+      line.remove_suffix(1);
+
+    auto bar = Bar{};
+    bar.timestamp = parse_timestamp_ns(next_field(line));
+    if (bar.timestamp != 0 and parse_field(line, bar.open) and
+        parse_field(line, bar.high) and parse_field(line, bar.low) and
+        parse_field(line, bar.close) and parse_field(line, bar.volume))
+      bars.push_back(bar);
+  }
+
+  return bars;
+}
+
+std::map<std::string, std::vector<Bar>>
+read_bars_csv_dir(const std::filesystem::path &dir) {
+  auto all_bars = std::map<std::string, std::vector<Bar>>{};
+
+  auto ec = std::error_code{};
+  for (const auto &entry : std::filesystem::directory_iterator{dir, ec}) {
+    const auto name = entry.path().filename().string();
+    if (not name.starts_with(csv_prefix) or not name.ends_with(csv_extension))
+      continue;
+
+    const auto symbol = name.substr(
+        csv_prefix.size(), name.size() - csv_prefix.size() - csv_extension.size());
+    if (auto bars = read_bars_csv(entry.path()); not bars.empty())
+      all_bars[symbol] = std::move(bars);
+  }
+
+  return all_bars;
+}
+
+void write_bars_csv_dir(const std::filesystem::path &dir,
+                        const std::map<std::string, std::vector<Bar>> &all_bars) {
+  auto ec = std::error_code{};
+  std::filesystem::create_directories(dir, ec);
+
+  for (const auto &[symbol, bars] : all_bars) {
+    const auto path =
+        dir / (std::string{csv_prefix} + symbol + std::string{csv_extension});
+    auto file = std::ofstream{path};
+
+    if (not file)
+      continue;
+
+    // Format the whole file in memory, then write it in one call
+    // Prices use the shortest representation that round-trips exactly
+    auto text = std::string{"timestamp,open,high,low,close,volume\n"};
+    text.reserve(bars.size() * 64);
+    for (const auto &bar : bars)
+      text += std::format("{},{},{},{},{},{}\n", format_timestamp(bar.timestamp),
+                          bar.open, bar.high, bar.low, bar.close, bar.volume);
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+
+    std::println("  📊 Exported {} bars for {} to {}", bars.size(), symbol,
+                 path.string());
+  }
+}
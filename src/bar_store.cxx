@@ -0,0 +1,221 @@
+#include "bar_store.h"
+#include "timestamps.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <span>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+constexpr char bar_file_magic[8] = {'L', 'F', 'T', 'B', 'A', 'R', 'S', '\0'};
+
+// Replace characters that aren't safe in file names (e.g. BTC/USD)
+std::string sanitise(std::string_view name) {
+  auto safe = std::string{name};
+  std::ranges::replace(safe, '/', '_');
+  return safe;
+}
+
+} // anonymous namespace
+
+MappedBars::MappedBars(const std::filesystem::path &path) {
+  const auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat st{};
+  if (::fstat(fd, &st) == 0 and st.st_size > 0) {
+    auto *addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                        PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      data_ = static_cast<const std::byte *>(addr);
+      size_ = static_cast<std::size_t>(st.st_size);
+    }
+  }
+
+  ::close(fd);
+
+  if (size_ < sizeof(BarFileHeader))
+    return;
+
+  auto header = BarFileHeader{};
+  std::memcpy(&header, data_, sizeof(header));
+
+  // Reject files from other versions or truncated writes
+  const auto expected_size =
+      sizeof(BarFileHeader) + header.count * bar_file_columns * 8uz;
+  if (std::memcmp(header.magic, bar_file_magic, sizeof(bar_file_magic)) != 0 or
+      header.version != bar_file_version or
+      header.header_size != sizeof(BarFileHeader) or size_ != expected_size)
+    return;
+
+  count_ = header.count;
+}
+
+MappedBars::~MappedBars() {
+  if (data_)
+    ::munmap(const_cast<std::byte *>(data_), size_);
+}
+
+MappedBars::MappedBars(MappedBars &&other) noexcept
+    : data_{std::exchange(other.data_, nullptr)},
+      size_{std::exchange(other.size_, 0)},
+      count_{std::exchange(other.count_, 0)} {}
+
+MappedBars &MappedBars::operator=(MappedBars &&other) noexcept {
+  if (this != &other) {
+    if (data_)
+      ::munmap(const_cast<std::byte *>(data_), size_);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    count_ = std::exchange(other.count_, 0);
+  }
+  return *this;
+}
+
+std::pair<std::size_t, std::size_t>
+MappedBars::range(std::int64_t from_ns, std::int64_t to_ns) const {
+  const auto ts = timestamps();
+  const auto first = std::ranges::lower_bound(ts, from_ns);
+  const auto last = std::ranges::lower_bound(first, ts.end(), to_ns);
+  return {static_cast<std::size_t>(first - ts.begin()),
+          static_cast<std::size_t>(std::max(first, last) - ts.begin())};
+}
+
+std::vector<Bar> MappedBars::bars(std::size_t first, std::size_t last) const {
+  const auto ts = timestamps();
+  const auto o = opens();
+  const auto h = highs();
+  const auto l = lows();
+  const auto c = closes();
+  const auto v = volumes();
+
+  auto result = std::vector<Bar>{};
+  result.reserve(last - first);
+  for (auto i = first; i < last; ++i)
+    result.push_back({.timestamp = ts[i],
+                      .open = o[i],
+                      .high = h[i],
+                      .low = l[i],
+                      .close = c[i],
+                      .volume = static_cast<long>(v[i])});
+
+  return result;
+}
+
+BarStore::BarStore(std::filesystem::path dir) : dir_{std::move(dir)} {}
+
+std::filesystem::path BarStore::path_for(std::string_view symbol,
+                                         std::string_view timeframe) const {
+  return dir_ / (sanitise(symbol) + "_" + std::string{timeframe} + ".bars");
+}
+
+MappedBars BarStore::map(std::string_view symbol,
+                         std::string_view timeframe) const {
+  return MappedBars{path_for(symbol, timeframe)};
+}
+
+std::vector<Bar> BarStore::load(std::string_view symbol,
+                                std::string_view timeframe) const {
+  const auto series = map(symbol, timeframe);
+  return series.bars(0, series.size());
+}
+
+std::vector<Bar> BarStore::load(std::string_view symbol,
+                                std::string_view timeframe,
+                                std::int64_t from_ns,
+                                std::int64_t to_ns) const {
+  const auto series = map(symbol, timeframe);
+  const auto [first, last] = series.range(from_ns, to_ns);
+  return series.bars(first, last);
+}
+
+bool BarStore::save(std::string_view symbol, std::string_view timeframe,
+                    const std::vector<Bar> &bars) const {
+  auto ec = std::error_code{};
+  std::filesystem::create_directories(dir_, ec);
+  if (ec)
+    return false;
+
+  const auto path = path_for(symbol, timeframe);
+  const auto tmp_path = std::filesystem::path{path.string() + ".tmp"};
+
+  // Gather columns
+  const auto count = bars.size();
+  auto timestamps = std::vector<std::int64_t>(count);
+  auto opens = std::vector<double>(count);
+  auto highs = std::vector<double>(count);
+  auto lows = std::vector<double>(count);
+  auto closes = std::vector<double>(count);
+  auto volumes = std::vector<std::int64_t>(count);
+
+  for (auto i = 0uz; i < count; ++i) {
+    timestamps[i] = bars[i].timestamp;
+    opens[i] = bars[i].open;
+    highs[i] = bars[i].high;
+    lows[i] = bars[i].low;
+    closes[i] = bars[i].close;
+    volumes[i] = bars[i].volume;
+  }
+
+  auto header = BarFileHeader{};
+  std::memcpy(header.magic, bar_file_magic, sizeof(bar_file_magic));
+  header.version = bar_file_version;
+  header.header_size = sizeof(BarFileHeader);
+  header.count = count;
+  header.first_timestamp = timestamps.empty() ? 0 : timestamps.front();
+  header.last_timestamp = timestamps.empty() ? 0 : timestamps.back();
+
+  {
+    auto file = std::ofstream{tmp_path, std::ios::binary | std::ios::trunc};
+    if (not file)
+      return false;
+
+    const auto write_column = [&file](const auto &values) {
+      file.write(reinterpret_cast<const char *>(values.data()),
+                 static_cast<std::streamsize>(values.size() *
+                                              sizeof(values.front())));
+    };
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (count > 0) {
+      write_column(timestamps);
+      write_column(opens);
+      write_column(highs);
+      write_column(lows);
+      write_column(closes);
+      write_column(volumes);
+    }
+
+    if (not file)
+      return false;
+  }
+
+  // Atomic replace so a crash mid-write never leaves a corrupt cache
+  std::filesystem::rename(tmp_path, path, ec);
+  return not ec;
+}
+
+void merge_bars(std::vector<Bar> &cached, const std::vector<Bar> &fresh) {
+  if (fresh.empty())
+    return;
+
+  const auto first_fresh = fresh.front().timestamp;
+  std::erase_if(cached, [first_fresh](const auto &bar) {
+    return bar.timestamp >= first_fresh;
+  });
+
+  cached.insert(cached.end(), fresh.begin(), fresh.end());
+}
+
+void trim_bars(std::vector<Bar> &bars, std::int64_t oldest_ns) {
+  std::erase_if(bars, [oldest_ns](const auto &bar) {
+    return bar.timestamp < oldest_ns;
+  });
+}
@@ -0,0 +1,458 @@
+// Micro-benchmarks for the trading hot paths
+// Every case runs on fixed synthetic inputs (seeded generator), so results
+// are comparable between runs and machines
+//
+// Usage: lft_bench [--filter TEXT] [--min-time MS] [--out FILE]
+//   --filter TEXT  Only run cases whose name contains TEXT
+//   --min-time MS  Minimum measured time per case (default 200)
+//   --out FILE     JSON results (default bench_results.json)
+//
+// Build in Release for meaningful numbers: make bench
+
+#include "alpaca_client.h"
+#include "backtest.h"
+#include "cross_section.h"
+#include "strategies.h"
+#include "thread_pool.h"
+#include "timestamps.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <map>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Count every heap allocation in the process (allocs/op)
+namespace {
+std::atomic<std::size_t> allocations{0};
+} // anonymous namespace
+
+// Out of line so GCC doesn't pair an inlined malloc()/free() with the
+// new-expressions and deletes it is matched against
+[[gnu::noinline]] void *operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void *operator new(std::size_t size,
+                                     std::align_val_t align) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto alignment = static_cast<std::size_t>(align);
+  const auto rounded = (std::max(size, 1uz) + alignment - 1) / alignment * alignment;
+  if (auto *p = std::aligned_alloc(alignment, rounded))
+    return p;
+  throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+[[gnu::noinline]] void operator delete(void *p, std::align_val_t) noexcept {
+  std::free(p);
+}
+[[gnu::noinline]] void operator delete(void *p, std::size_t,
+                                       std::align_val_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+// Keep a value alive so the optimiser can't drop the work producing it
+template <typename T> void keep(const T &value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct BenchResult {
+  std::string name;
+  std::size_t iterations{};
+  double ns_per_op{};
+  double allocs_per_op{};
+  std::optional<double> bars_per_sec; // For cases that consume bars
+};
+
+struct BenchOptions {
+  std::string filter;
+  Clock::duration min_time{std::chrono::milliseconds{200}};
+};
+
+// Run op() in growing batches until a batch takes at least min_time
+// bars_per_op is the number of bars each op consumes (0 if not bar-based)
+template <typename Op>
+BenchResult measure(std::string_view name, const BenchOptions &options,
+                    std::size_t bars_per_op, Op &&op) {
+  op(); // Warm up caches and lazily built state
+
+  for (auto iterations = 1uz;; iterations *= 2) {
+    const auto allocs_before = allocations.load(std::memory_order_relaxed);
+    const auto start = Clock::now();
+    for (auto i = 0uz; i < iterations; ++i)
+      op();
+    const auto elapsed = Clock::now() - start;
+    const auto allocs =
+        allocations.load(std::memory_order_relaxed) - allocs_before;
+
+    if (elapsed < options.min_time and iterations < (1uz << 40))
+      continue;
+
+    const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    auto result = BenchResult{
+        .name = std::string{name},
+        .iterations = iterations,
+        .ns_per_op = ns / static_cast<double>(iterations),
+        .allocs_per_op =
+            static_cast<double>(allocs) / static_cast<double>(iterations),
+        .bars_per_sec = std::nullopt,
+    };
+    if (bars_per_op > 0)
+      result.bars_per_sec = static_cast<double>(bars_per_op) *
+                            static_cast<double>(iterations) / (ns * 1e-9);
+    return result;
+  }
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// SYNTHETIC INPUTS
+// ═══════════════════════════════════════════════════════════════════════
+
+constexpr auto bench_symbols = 50uz;
+constexpr auto bench_days = 30uz;
+constexpr auto bars_per_day = 26uz; // 15-minute bars, 14:30-20:45 UTC
+
+// Random-walk 15-minute bars for the regular session of consecutive days
+std::vector<Bar> synthetic_bars(std::mt19937 &rng, double start_price,
+                                std::size_t days) {
+  auto returns = std::normal_distribution<double>{0.0, 0.004};
+  auto volumes = std::uniform_int_distribution<long>{1000, 6000};
+  const auto first_open = parse_timestamp_ns("2024-01-02T14:30:00Z");
+  constexpr auto bar_ns = 15 * 60 * ns_per_second;
+
+  auto bars = std::vector<Bar>{};
+  bars.reserve(days * bars_per_day);
+  auto price = start_price;
+  for (auto day = 0uz; day < days; ++day)
+    for (auto slot = 0uz; slot < bars_per_day; ++slot) {
+      const auto open = price;
+      price *= 1.0 + returns(rng);
+      bars.push_back(Bar{
+          .timestamp = first_open +
+                       static_cast<std::int64_t>(day) * ns_per_day +
+                       static_cast<std::int64_t>(slot) * bar_ns,
+          .open = open,
+          .high = std::max(open, price) * 1.001,
+          .low = std::min(open, price) * 0.999,
+          .close = price,
+          .volume = volumes(rng),
+      });
+    }
+  return bars;
+}
+
+std::map<std::string, std::vector<Bar>> synthetic_market() {
+  auto rng = std::mt19937{42};
+  auto market = std::map<std::string, std::vector<Bar>>{};
+  for (auto s = 0uz; s < bench_symbols; ++s)
+    market[std::format("SYM{:02}", s)] =
+        synthetic_bars(rng, 50.0 + static_cast<double>(s), bench_days);
+  return market;
+}
+
+// Bars response bodies shaped like Alpaca's
+std::string bars_json(const std::vector<Bar> &bars) {
+  auto body = json::object();
+  auto &array = body["bars"] = json::array();
+  for (const auto &bar : bars)
+    array.push_back({{"t", format_timestamp(bar.timestamp)}, {"o", bar.open},
+                     {"h", bar.high}, {"l", bar.low}, {"c", bar.close},
+                     {"v", bar.volume}, {"n", 42}, {"vw", bar.close}});
+  body["next_page_token"] = nullptr;
+  return body.dump();
+}
+
+std::string multi_bars_json(const std::map<std::string, std::vector<Bar>> &market) {
+  auto body = json::object();
+  auto &symbols = body["bars"] = json::object();
+  for (const auto &[symbol, bars] : market)
+    symbols[symbol] = json::parse(bars_json(bars))["bars"];
+  body["next_page_token"] = nullptr;
+  return body.dump();
+}
+
+// Snapshots response body shaped like Alpaca's, one entry per symbol
+std::string snapshots_json(const std::map<std::string, std::vector<Bar>> &market) {
+  auto body = json::object();
+  for (const auto &[symbol, bars] : market) {
+    const auto &bar = bars.back();
+    const auto timestamp = format_timestamp(bar.timestamp);
+    const auto bar_json = json{{"t", timestamp},     {"o", bar.open},
+                               {"h", bar.high},      {"l", bar.low},
+                               {"c", bar.close},     {"v", bar.volume},
+                               {"n", 42},            {"vw", bar.close}};
+    body[symbol] = {
+        {"latestTrade",
+         {{"t", timestamp}, {"x", "V"}, {"p", bar.close}, {"s", 100},
+          {"c", json::array({"@"})}, {"i", 52983525029461}, {"z", "C"}}},
+        {"latestQuote",
+         {{"t", timestamp}, {"ax", "V"}, {"ap", bar.close * 1.0005},
+          {"as", 2}, {"bx", "V"}, {"bp", bar.close * 0.9995}, {"bs", 3},
+          {"c", json::array({"R"})}, {"z", "C"}}},
+        {"minuteBar", bar_json},
+        {"dailyBar", bar_json},
+        {"prevDailyBar", bar_json},
+    };
+  }
+  return body.dump();
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// DOM REFERENCE PARSERS
+// ═══════════════════════════════════════════════════════════════════════
+
+// The document-building decoders AlpacaClient used before the streaming
+// ones, kept here as the baseline for the json/sax cases
+
+Bar dom_bar(const json &bar_json) {
+  auto bar = Bar{};
+  bar.timestamp = parse_timestamp_ns(bar_json["t"].get<std::string>());
+  bar.open = bar_json["o"].get<double>();
+  bar.high = bar_json["h"].get<double>();
+  bar.low = bar_json["l"].get<double>();
+  bar.close = bar_json["c"].get<double>();
+  bar.volume = bar_json["v"].get<long>();
+  return bar;
+}
+
+BarPage dom_parse_bars_page(std::string_view body) {
+  auto data = json::parse(body);
+  auto page = BarPage{};
+  page.bars.reserve(data["bars"].size());
+  for (const auto &bar_json : data["bars"])
+    page.bars.push_back(dom_bar(bar_json));
+  if (data["next_page_token"].is_string())
+    page.next_page_token = data["next_page_token"].get<std::string>();
+  return page;
+}
+
+MultiBarPage dom_parse_multi_bars_page(std::string_view body) {
+  auto data = json::parse(body);
+  auto page = MultiBarPage{};
+  for (const auto &[symbol, bars_json] : data["bars"].items()) {
+    auto &bars = page.bars[symbol];
+    bars.reserve(bars_json.size());
+    for (const auto &bar_json : bars_json)
+      bars.push_back(dom_bar(bar_json));
+  }
+  if (data["next_page_token"].is_string())
+    page.next_page_token = data["next_page_token"].get<std::string>();
+  return page;
+}
+
+std::map<std::string, Snapshot> dom_parse_snapshots(std::string_view body) {
+  const auto document = json::parse(body);
+  auto snapshots = std::map<std::string, Snapshot>{};
+  for (const auto &[symbol, data] : document.items()) {
+    auto snap = Snapshot{};
+    snap.symbol = symbol;
+    snap.latest_trade_price = data["latestTrade"]["p"];
+    snap.latest_trade_timestamp =
+        parse_timestamp_ns(data["latestTrade"]["t"].get<std::string>());
+    snap.latest_quote_bid = data["latestQuote"]["bp"];
+    snap.latest_quote_ask = data["latestQuote"]["ap"];
+    snap.prev_daily_bar_close = data["prevDailyBar"]["c"];
+    snap.minute_bar_volume = data["minuteBar"]["v"];
+    snapshots[symbol] = snap;
+  }
+  return snapshots;
+}
+
+// ═══════════════════════════════════════════════════════════════════════
+// CASES
+// ═══════════════════════════════════════════════════════════════════════
+
+void run_cases(const BenchOptions &options, std::vector<BenchResult> &results) {
+  const auto market = synthetic_market();
+  const auto &series = market.begin()->second;
+
+  // One symbol's history and strategy state after its whole series
+  auto warm = PriceHistory{};
+  auto strategies = StrategySet{};
+  for (const auto &bar : series) {
+    warm.add_bar(bar.close, bar.high, bar.low, bar.volume);
+    strategies.on_bar(warm);
+  }
+
+  auto total_bars = 0uz;
+  for (const auto &[symbol, bars] : market)
+    total_bars += bars.size();
+
+  const auto selected = [&](std::string_view name) {
+    return name.find(options.filter) != std::string_view::npos;
+  };
+  const auto run = [&](std::string_view name, std::size_t bars_per_op,
+                       auto &&op) {
+    if (not selected(name))
+      return;
+    results.push_back(measure(name, options, bars_per_op, op));
+    const auto &r = results.back();
+    std::println("  {:<40} {:>12.1f} ns/op {:>9.2f} allocs/op {:>14}", r.name,
+                 r.ns_per_op, r.allocs_per_op,
+                 r.bars_per_sec ? std::format("{:.0f} bars/s", *r.bars_per_sec)
+                                : std::string{});
+  };
+
+  // PriceHistory: one bar into a full window (the steady state)
+  run("price_history/add_bar", 1, [&, history = warm, i = 0uz]() mutable {
+    const auto &bar = series[i++ % series.size()];
+    history.add_bar(bar.close, bar.high, bar.low, bar.volume);
+    keep(history);
+  });
+  run("price_history/indicators", 0, [&] {
+    keep(warm.moving_average(ma_short_periods));
+    keep(warm.moving_average(ma_long_periods));
+    keep(warm.price_std_dev(ma_long_periods));
+    keep(warm.recent_noise(noise_periods));
+    keep(warm.volatility());
+    keep(warm.avg_volume());
+  });
+
+  // Stateless evaluators
+  const auto market_average = std::optional<double>{0.0};
+  run("strategies/evaluate_dip", 0,
+      [&] { keep(Strategies::evaluate_dip(warm, -0.5)); });
+  run("strategies/evaluate_mean_reversion", 0,
+      [&] { keep(Strategies::evaluate_mean_reversion(warm)); });
+  run("strategies/evaluate_relative_strength", 0, [&] {
+    keep(Strategies::evaluate_relative_strength(warm, market_average));
+  });
+  run("strategies/evaluate_volume_surge", 0,
+      [&] { keep(Strategies::evaluate_volume_surge(warm)); });
+
+  // Stateful strategies, as the backtest and live loop drive them
+  const auto context = MarketContext{.average_change = market_average};
+  for_each_strategy([&](auto id) {
+    constexpr auto strategy = decltype(id)::value;
+    run(std::format("strategy_set/{}", strategy_names[strategy]), 0,
+        [&] { keep(strategies.signal<strategy>(warm, context)); });
+  });
+  run("strategy_set/on_bar", 0, [&, set = strategies]() mutable {
+    set.on_bar(warm);
+    keep(set);
+  });
+
+  // JSON decoding of AlpacaClient response bodies: the streaming decoders
+  // against the DOM baseline
+  const auto page_body = bars_json(series);
+  const auto multi_body = multi_bars_json(market);
+  const auto snapshots_body = snapshots_json(market);
+  run("json/dom/parse_bars_page", series.size(),
+      [&] { keep(dom_parse_bars_page(page_body)); });
+  run("json/sax/parse_bars_page", series.size(),
+      [&] { keep(parse_bars_page(page_body)); });
+  run("json/dom/parse_multi_bars_page", total_bars,
+      [&] { keep(dom_parse_multi_bars_page(multi_body)); });
+  run("json/sax/parse_multi_bars_page", total_bars,
+      [&] { keep(parse_multi_bars_page(multi_body)); });
+  run("json/dom/parse_snapshots", 0,
+      [&] { keep(dom_parse_snapshots(snapshots_body)); });
+  run("json/sax/parse_snapshots", 0,
+      [&] { keep(parse_snapshots(snapshots_body)); });
+
+  // Cross-sectional kernels over the whole synthetic watchlist
+  auto cross_section = CrossSection{market.size(), max_history_size};
+  for (auto i = 0uz; const auto &[symbol, bars] : market)
+    cross_section.load(i++, bars);
+  run("cross_section/volume_ratio", 0,
+      [&] { keep(cross_section.volume_ratio(ma_long_periods)); });
+
+  // Full calibration backtest, serial and on every core
+  const auto cores = std::max(1uz, static_cast<std::size_t>(
+                                       std::thread::hardware_concurrency()));
+  for (const auto threads : cores > 1 ? std::vector{1uz, cores}
+                                      : std::vector{1uz}) {
+    auto pool = ThreadPool{threads};
+    run(std::format("backtest/run_backtest/threads:{}", threads), total_bars,
+        [&] {
+          keep(run_backtest(StrategyMask::all(), market, 100000.0, pool));
+        });
+  }
+}
+
+void write_results(const std::string &path,
+                   const std::vector<BenchResult> &results) {
+  auto cases = json::array();
+  for (const auto &r : results)
+    cases.push_back({{"name", r.name},
+                     {"iterations", r.iterations},
+                     {"ns_per_op", r.ns_per_op},
+                     {"allocs_per_op", r.allocs_per_op},
+                     {"bars_per_sec", r.bars_per_sec ? json(*r.bars_per_sec)
+                                                     : json(nullptr)}});
+
+  const auto output = json{
+      {"timestamp", format_timestamp(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count())},
+#ifdef NDEBUG
+      {"build", "release"},
+#else
+      {"build", "debug"},
+#endif
+      {"threads", std::thread::hardware_concurrency()},
+      {"cases", cases},
+  };
+
+  auto file = std::ofstream{path};
+  file << output.dump(2) << "\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  auto options = BenchOptions{};
+  auto out = std::string{"bench_results.json"};
+
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--filter" and i + 1 < argc) {
+      options.filter = argv[++i];
+    } else if (arg == "--min-time" and i + 1 < argc) {
+      options.min_time = std::chrono::milliseconds{std::atoi(argv[++i])};
+    } else if (arg == "--out" and i + 1 < argc) {
+      out = argv[++i];
+    } else {
+      std::println(stderr,
+                   "Usage: {} [--filter TEXT] [--min-time MS] [--out FILE]",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  std::println("⏱️  LFT benchmarks");
+#ifndef NDEBUG
+  std::println("  ⚠️  Debug build: assertions are on, numbers are not "
+               "representative (use make bench)");
+#endif
+
+  auto results = std::vector<BenchResult>{};
+  run_cases(options, results);
+
+  write_results(out, results);
+  std::println("\n  {} cases written to {}", results.size(), out);
+  return 0;
+}
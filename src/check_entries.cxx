@@ -3,6 +3,8 @@
 
 #include "lft.h"
 #include "defs.h"
+#include "market_data_cache.h"
+#include "position_book.h"
 #include "strategies.h"
 #include <chrono>
 #include <format>
@@ -14,12 +16,10 @@
 #include <vector>
 
 // Import global tracking state (defined in globals.cxx)
-extern std::map<std::string, std::string> position_strategies;
-extern std::map<std::string, double> position_peaks;
-extern std::map<std::string, std::chrono::system_clock::time_point> position_entry_times;
+extern PositionBook position_book;
 
-void check_entries(AlpacaClient &client,
-                   const std::map<std::string, bool> &enabled_strategies) {
+void check_entries(AlpacaClient &client, const MarketDataCache &market_data,
+                   StrategyMask enabled_strategies) {
   // Fetch current positions to avoid duplicate entries
   const auto positions = client.get_positions();
   auto symbols_in_use = std::set<std::string>{};
@@ -27,37 +27,42 @@ void check_entries(AlpacaClient &client,
   for (const auto &pos : positions)
     symbols_in_use.insert(pos.symbol);
 
-  // Build price histories for relative strength (if strategy is enabled)
-  auto all_histories = std::map<std::string, PriceHistory>{};
-  if (enabled_strategies.contains("relative_strength") and
-      enabled_strategies.at("relative_strength")) {
-    for (const auto &sym : stocks) {
-      if (auto bars = client.get_bars(sym, "15Min", 100)) {
-        auto history = PriceHistory{};
-        for (const auto &bar : *bars)
-          history.add_bar(bar.close, bar.high, bar.low, bar.volume);
-        all_histories[sym] = history;
-      }
-    }
-  }
-
-  // Evaluate each watchlist symbol
-  for (const auto &symbol : stocks) {
-    // Skip if already in position (from API or our tracking)
-    if (symbols_in_use.contains(symbol) or position_strategies.contains(symbol))
-      continue;
-
-    // Fetch latest bar data and snapshot
-    auto bars_opt = client.get_bars(symbol, "15Min", 100);
-    auto snapshot_opt = client.get_snapshot(symbol);
-
-    if (not bars_opt or not snapshot_opt) {
+  // Market average for relative strength and volume ratios, computed once
+  // from the shared cache (the same figures evaluation shows)
+  const auto market = market_data.market_context();
+  const auto volume_ratios = market_data.volume_ratios();
+
+  // Candidate symbols: skip if already in position (from API or our tracking)
+  auto candidates = std::vector<std::string>{};
+  for (const auto &symbol : stocks)
+    if (not symbols_in_use.contains(symbol) and
+        not position_book.entered(symbol))
+      candidates.push_back(symbol);
+
+  // One batched snapshot request for all candidates
+  const auto snapshots = fetch_snapshot_map(client, candidates);
+
+  // Orders to place once every candidate has been evaluated
+  struct PendingOrder {
+    std::string symbol;
+    std::size_t strategy;
+    std::string client_order_id;
+    std::chrono::system_clock::time_point signalled_at;
+  };
+  auto orders = std::vector<PendingOrder>{};
+
+  // Evaluate each candidate symbol
+  for (const auto &symbol : candidates) {
+    // Latest bars from the cache
+    const auto *cached_bars = market_data.bars(symbol);
+    const auto snapshot_it = snapshots.find(symbol);
+
+    if (not cached_bars or snapshot_it == snapshots.end()) {
       std::println("  ⚠️  {} - data fetch failed, skipping", symbol);
       continue;
     }
 
-    const auto &bars = *bars_opt;
-    const auto &snapshot = *snapshot_opt;
+    const auto &snapshot = snapshot_it->second;
 
     // Check spread filter (uses industry-standard mid-price calculation)
     const auto spread_bps = Strategies::calculate_spread_bps(snapshot);
@@ -66,46 +71,27 @@ void check_entries(AlpacaClient &client,
       continue;
     }
 
-    // Check volume filter (current volume vs 20-bar average)
-    if (bars.size() >= 20) {
-      auto total_volume = 0.0;
-      for (auto i = bars.size() - 20; i < bars.size(); ++i)
-        total_volume += bars[i].volume;
-      const auto avg_volume = total_volume / 20.0;
-      const auto current_volume = bars.back().volume;
-      const auto volume_ratio = current_volume / avg_volume;
-
-      if (volume_ratio < min_volume_ratio) {
-        std::println("  {} - low volume ({:.1f}% of average)", symbol, volume_ratio * 100.0);
-        continue;
-      }
+    // Check volume filter (current volume vs 20-bar average, 0 with fewer
+    // bars, so symbols without a full window are not entered)
+    const auto volume_ratio_it = volume_ratios.find(symbol);
+    const auto volume_ratio =
+        volume_ratio_it == volume_ratios.end() ? 0.0 : volume_ratio_it->second;
+    if (volume_ratio < min_volume_ratio) {
+      std::println("  {} - low volume ({:.1f}% of average)", symbol, volume_ratio * 100.0);
+      continue;
     }
 
-    // Convert bars to PriceHistory
-    auto history = PriceHistory{};
-    for (const auto &bar : bars)
-      history.add_bar(bar.close, bar.high, bar.low, bar.volume);
-
-    // Evaluate all strategies
-    auto signals = std::vector<StrategySignal>{
-        Strategies::evaluate_ma_crossover(history),
-        Strategies::evaluate_mean_reversion(history),
-        Strategies::evaluate_volatility_breakout(history),
-        Strategies::evaluate_relative_strength(history, all_histories),
-        Strategies::evaluate_volume_surge(history)
-    };
-
-    // Find first enabled signal
-    for (const auto &signal : signals) {
-      if (not signal.should_buy)
-        continue;
+    // Evaluate all strategies from the cache's per-symbol state
+    const auto &history = market_data.histories().at(symbol);
+    const auto signals = market_data.strategies(symbol)->signals(history, market);
 
-      if (not enabled_strategies.contains(signal.strategy_name) or
-          not enabled_strategies.at(signal.strategy_name))
+    // Find first enabled signal (signals are indexed by strategy ID)
+    for (auto id = 0uz; id < strategy_count; ++id) {
+      const auto &signal = signals[id];
+      if (not signal.should_buy or not enabled_strategies.test(id))
         continue;
 
       std::println("🚨 SIGNAL: {} - {} ({})", symbol, signal.strategy_name, signal.reason);
-      std::println("   Placing order for ${:.2f}...", notional_amount);
 
       // Create unique client_order_id with timestamp
       const auto now = std::chrono::system_clock::now();
@@ -115,36 +101,50 @@ void check_entries(AlpacaClient &client,
           symbol, signal.strategy_name, timestamp_ms,
           take_profit_pct * 100.0, stop_loss_pct * 100.0, trailing_stop_pct * 100.0);
 
-      auto order = client.place_order(symbol, "buy", notional_amount, client_order_id);
-      if (order) {
-        // Parse order response to verify status
-        auto order_json = nlohmann::json::parse(order.value(), nullptr, false);
-        if (not order_json.is_discarded()) {
-          const auto order_id = order_json.value("id", "unknown");
-          const auto status = order_json.value("status", "unknown");
-          const auto side = order_json.value("side", "unknown");
-          const auto notional_str = order_json.value("notional", "0");
-
-          std::println("✅ Order placed: ID={} status={} side={} notional=${}",
-                       order_id, status, side, notional_str);
-
-          // Only count as executed if order is accepted
-          if (status == "accepted" or status == "pending_new" or status == "filled") {
-            // Track the position immediately
-            position_strategies[symbol] = signal.strategy_name;
-            position_entry_times[symbol] = now;
-            symbols_in_use.insert(symbol);  // Prevent duplicate orders in same evaluation cycle
-          } else {
-            std::println("⚠️  Order not accepted: status={}", status);
-          }
+      orders.push_back({symbol, id, client_order_id, now});
+      break;  // Only one strategy per symbol
+    }
+  }
+
+  if (orders.empty())
+    return;
+
+  // Place every order concurrently rather than one round trip at a time
+  std::println("   Placing {} orders for ${:.2f} each...", orders.size(), notional_amount);
+  const auto responses = client.fan_out(orders.size(), [&](std::size_t i) {
+    return client.place_order(orders[i].symbol, "buy", notional_amount,
+                              orders[i].client_order_id);
+  });
+
+  for (auto i = 0uz; i < orders.size(); ++i) {
+    const auto &symbol = orders[i].symbol;
+    const auto &order = responses[i];
+
+    if (order) {
+      // Parse order response to verify status
+      auto order_json = nlohmann::json::parse(order.value(), nullptr, false);
+      if (not order_json.is_discarded()) {
+        const auto order_id = order_json.value("id", "unknown");
+        const auto status = order_json.value("status", "unknown");
+        const auto side = order_json.value("side", "unknown");
+        const auto notional_str = order_json.value("notional", "0");
+
+        std::println("✅ Order placed: {} ID={} status={} side={} notional=${}",
+                     symbol, order_id, status, side, notional_str);
+
+        // Only count as executed if order is accepted
+        if (status == "accepted" or status == "pending_new" or status == "filled") {
+          // Track the position immediately
+          position_book.opened(symbol, strategy_names[orders[i].strategy],
+                               orders[i].signalled_at);
         } else {
-          std::println("❌ Failed to parse order response");
+          std::println("⚠️  Order not accepted: {} status={}", symbol, status);
         }
       } else {
-        std::println("❌ Order failed: {}", symbol);
+        std::println("❌ Failed to parse order response: {}", symbol);
       }
-
-      break;  // Only one strategy per symbol
+    } else {
+      std::println("❌ Order failed: {}", symbol);
     }
   }
 }
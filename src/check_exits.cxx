@@ -1,21 +1,53 @@
 // Phase 3: Exit Checking
 // Split into two functions:
 // - check_normal_exits: TP/SL/trailing (every 15 minutes, same as entries)
-// - check_panic_exits: Emergency conditions (every 1 minute, fast reaction):
+// - check_panic_exits: Emergency conditions (every few seconds on the exit
+//   monitor thread, fast reaction):
 //   1. Catastrophic position loss (panic stop)
 //   2. EOD time cutoff reached
 
 #include "lft.h"
 #include "defs.h"
+#include "position_book.h"
+#include <algorithm>
 #include <map>
 #include <nlohmann/json.hpp>
 #include <print>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Import global tracking state (defined in globals.cxx)
-extern std::map<std::string, std::string> position_strategies;
-extern std::map<std::string, double> position_peaks;
-extern std::map<std::string, std::chrono::system_clock::time_point> position_entry_times;
+extern PositionBook position_book;
+
+namespace {
+
+std::vector<std::string> position_symbols(const std::vector<Position> &positions) {
+  auto symbols = std::vector<std::string>{};
+  for (const auto &pos : positions)
+    symbols.push_back(pos.symbol);
+  return symbols;
+}
+
+// Close positions concurrently, skipping any the other thread is already
+// closing; returns each position attempted and whether it closed
+std::vector<std::pair<Position, bool>>
+close_claimed(AlpacaClient &client, std::vector<Position> exits) {
+  std::erase_if(exits, [](const auto &pos) {
+    return not position_book.begin_close(pos.symbol);
+  });
+
+  const auto closed = close_positions(client, exits);
+
+  auto results = std::vector<std::pair<Position, bool>>{};
+  for (auto i = 0uz; i < exits.size(); ++i) {
+    position_book.finish_close(exits[i].symbol, closed[i].has_value());
+    results.emplace_back(std::move(exits[i]), closed[i].has_value());
+  }
+  return results;
+}
+
+} // anonymous namespace
 
 // Phase 3a: Normal exits (TP, SL, trailing) - checked every 15 minutes
 void check_normal_exits(AlpacaClient &client, std::chrono::system_clock::time_point now) {
@@ -29,22 +61,24 @@ void check_normal_exits(AlpacaClient &client, std::chrono::system_clock::time_po
     return;
   }
 
+  // One batched snapshot request for every open position
+  const auto snapshots = fetch_snapshot_map(client, position_symbols(positions));
+
+  // Positions to close once all have been checked
+  auto exits = std::vector<Position>{};
+
   for (const auto &pos : positions) {
-    // Fetch current price
-    if (auto snapshot = client.get_snapshot(pos.symbol)) {
-      const auto current_price = snapshot->latest_trade_price;
+    // Current price from the batched snapshots
+    if (auto snapshot = snapshots.find(pos.symbol); snapshot != snapshots.end()) {
+      const auto current_price = snapshot->second.latest_trade_price;
       const auto unrealized_pl = pos.unrealized_pl;
       const auto cost_basis = pos.avg_entry_price * pos.qty;
       const auto pl_pct = (unrealized_pl / cost_basis);
 
       // Update peak price for trailing stop
-      if (not position_peaks.contains(pos.symbol))
-        position_peaks[pos.symbol] = current_price;
-      else if (current_price > position_peaks[pos.symbol])
-        position_peaks[pos.symbol] = current_price;
+      const auto peak = position_book.update_peak(pos.symbol, current_price);
 
       // Calculate exit conditions
-      const auto peak = position_peaks[pos.symbol];
       const auto trailing_stop_price = peak * (1.0 - trailing_stop_pct);
       const auto trailing_stop_triggered = current_price < trailing_stop_price;
 
@@ -67,18 +101,7 @@ void check_normal_exits(AlpacaClient &client, std::chrono::system_clock::time_po
         std::println("{} {}: {} ${:.2f} ({:+.2f}%)",
                      unrealized_pl > 0.0 ? "💰" : "🛑", exit_reason,
                      pos.symbol, unrealized_pl, profit_percent);
-        std::println("   Closing position...");
-
-        if (client.close_position(pos.symbol)) {
-          std::println("✅ Position closed: {}", pos.symbol);
-
-          // Clean up tracking (cooldown no longer needed with 15-min entry cycle)
-          position_strategies.erase(pos.symbol);
-          position_peaks.erase(pos.symbol);
-          position_entry_times.erase(pos.symbol);
-        } else {
-          std::println("❌ Failed to close position: {}", pos.symbol);
-        }
+        exits.push_back(pos);
       } else {
         // Just log the position status
         const auto profit_percent = pl_pct * 100.0;
@@ -86,77 +109,69 @@ void check_normal_exits(AlpacaClient &client, std::chrono::system_clock::time_po
       }
     }
   }
-}
-
-// Phase 3b: Panic exits - checked every 1 minute for fast reaction
-// Handles EOD liquidation and catastrophic loss stops
-void check_panic_exits(AlpacaClient &client,
-                      std::chrono::system_clock::time_point now,
-                      std::chrono::system_clock::time_point eod_cutoff) {
-
-  // Check if past EOD cutoff - liquidate all positions immediately
-  if (now >= eod_cutoff) {
-    const auto positions = client.get_positions();
-
-    if (positions.empty())
-      return;
-
-    std::println("\n🚨 EOD CUTOFF - Liquidating all positions at {:%H:%M:%S}",
-                 std::chrono::floor<std::chrono::seconds>(now));
-
-    // Close all positions
-    for (const auto &pos : positions) {
-      std::println("   Closing {} (${:+.2f})", pos.symbol, pos.unrealized_pl);
-
-      if (client.close_position(pos.symbol)) {
-        std::println("   ✅ {} closed", pos.symbol);
-
-        // Clean up tracking
-        position_strategies.erase(pos.symbol);
-        position_peaks.erase(pos.symbol);
-        position_entry_times.erase(pos.symbol);
-      } else {
-        std::println("   ❌ Failed to close {}", pos.symbol);
-      }
-    }
 
+  if (exits.empty())
     return;
+
+  std::println("   Closing {} positions...", exits.size());
+  for (const auto &[pos, closed] : close_claimed(client, std::move(exits))) {
+    if (closed)
+      std::println("✅ Position closed: {}", pos.symbol);
+    else
+      std::println("❌ Failed to close position: {}", pos.symbol);
   }
+}
 
-  // Check individual position panic stops
+// Phase 3b: Panic exits - checked every few seconds by the exit monitor
+// Handles EOD liquidation and catastrophic loss stops, and keeps trailing
+// peaks current between normal exit checks
+std::vector<ExitNotice>
+check_panic_exits(AlpacaClient &client,
+                  std::chrono::system_clock::time_point now,
+                  std::chrono::system_clock::time_point eod_cutoff) {
   const auto positions = client.get_positions();
 
   if (positions.empty())
-    return;
+    return {};
 
-  for (const auto &pos : positions) {
-    // Fetch current price
-    if (auto snapshot = client.get_snapshot(pos.symbol)) {
-      const auto unrealized_pl = pos.unrealized_pl;
-      const auto cost_basis = pos.avg_entry_price * pos.qty;
-      const auto pl_pct = (unrealized_pl / cost_basis);
+  // Positions to close once all have been checked
+  auto exits = std::vector<Position>{};
+  auto reason = std::string_view{"PANIC STOP"};
 
-      // Check individual panic stop (catastrophic loss on this position)
-      const auto panic_stop_triggered = pl_pct <= -panic_stop_loss_pct;
+  if (now >= eod_cutoff) {
+    // Past EOD cutoff - liquidate all positions immediately
+    exits = positions;
+    reason = "EOD CUTOFF";
+  } else {
+    // One batched snapshot request for every open position
+    const auto snapshots =
+        fetch_snapshot_map(client, position_symbols(positions));
 
-      if (panic_stop_triggered) {
-        const auto profit_percent = pl_pct * 100.0;
+    for (const auto &pos : positions) {
+      // Only act on positions with a current quote
+      const auto snapshot = snapshots.find(pos.symbol);
+      if (snapshot == snapshots.end())
+        continue;
 
-        std::println("🚨 PANIC STOP: {} ${:.2f} ({:+.2f}%)",
-                     pos.symbol, unrealized_pl, profit_percent);
-        std::println("   Closing position immediately...");
-
-        if (client.close_position(pos.symbol)) {
-          std::println("✅ Position closed: {}", pos.symbol);
-
-          // Clean up tracking
-          position_strategies.erase(pos.symbol);
-          position_peaks.erase(pos.symbol);
-          position_entry_times.erase(pos.symbol);
-        } else {
-          std::println("❌ Failed to close position: {}", pos.symbol);
-        }
-      }
+      if (const auto price = snapshot->second.latest_trade_price; price > 0.0)
+        position_book.update_peak(pos.symbol, price);
+
+      // Check individual panic stop (catastrophic loss on this position)
+      const auto cost_basis = pos.avg_entry_price * pos.qty;
+      const auto pl_pct = pos.unrealized_pl / cost_basis;
+      if (pl_pct <= -panic_stop_loss_pct)
+        exits.push_back(pos);
     }
   }
+
+  auto notices = std::vector<ExitNotice>{};
+  for (const auto &[pos, closed] : close_claimed(client, std::move(exits)))
+    notices.push_back({.symbol = pos.symbol,
+                       .reason = reason,
+                       .unrealized_pl = pos.unrealized_pl,
+                       .pl_pct = pos.unrealized_pl /
+                                 (pos.avg_entry_price * pos.qty),
+                       .at = now,
+                       .closed = closed});
+  return notices;
 }
@@ -0,0 +1,160 @@
+#include "connection_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+// Idle clients kept per host; extra clients from bursts are closed on release
+constexpr auto max_idle_connections = 8uz;
+
+// Times a request refused with 429 is resent before giving up
+constexpr auto max_rate_limit_retries = 3;
+
+// Longest we'll hold requests for after a 429
+constexpr auto max_rate_limit_pause = std::chrono::seconds{60};
+
+// Numeric response header, or 0.0 if absent
+double header_number(const httplib::Response &res, const std::string &name) {
+  return std::strtod(res.get_header_value(name).c_str(), nullptr);
+}
+
+// When to resume after the nth 429 in a row: the server's Retry-After or
+// X-RateLimit-Reset (epoch seconds) if it sent one, else exponential backoff
+RateLimiter::clock::time_point resume_time(const httplib::Response &res,
+                                           int retry) {
+  auto delay = std::chrono::duration<double>(1 << retry);
+  if (const auto after = header_number(res, "Retry-After"); after > 0.0)
+    delay = std::chrono::duration<double>(after);
+  else if (const auto reset = header_number(res, "X-RateLimit-Reset");
+           reset > 0.0)
+    delay = std::chrono::duration<double>(reset) -
+            std::chrono::system_clock::now().time_since_epoch();
+
+  delay = std::clamp(delay, std::chrono::duration<double>(0.0),
+                     std::chrono::duration<double>(max_rate_limit_pause));
+  return RateLimiter::clock::now() +
+         std::chrono::duration_cast<RateLimiter::clock::duration>(delay);
+}
+
+// Latency histogram name for a host ("https://x.com" -> "http.x.com")
+std::string latency_name(const std::string &host) {
+  const auto scheme = host.find("://");
+  return "http." + (scheme == std::string::npos ? host : host.substr(scheme + 3));
+}
+} // namespace
+
+ConnectionPool::ConnectionPool(std::string host, RateLimiter &limiter)
+    : host_{std::move(host)}, limiter_{limiter},
+      latency_{latency_histogram(latency_name(host_))} {}
+
+std::unique_ptr<httplib::Client> ConnectionPool::acquire() {
+  {
+    auto lock = std::lock_guard{mutex_};
+    if (not idle_.empty()) {
+      auto client = std::move(idle_.back());
+      idle_.pop_back();
+      return client;
+    }
+  }
+
+  auto client = std::make_unique<httplib::Client>(host_);
+  client->set_keep_alive(true);
+  return client;
+}
+
+void ConnectionPool::release(std::unique_ptr<httplib::Client> client) {
+  auto lock = std::lock_guard{mutex_};
+  if (idle_.size() < max_idle_connections)
+    idle_.push_back(std::move(client));
+}
+
+template <typename Request>
+httplib::Result ConnectionPool::send(Timeouts timeouts, bool idempotent,
+                                     Request &&request) {
+  const auto timer = ScopedTimer{latency_};
+  auto client = acquire();
+
+  const auto attempt = [&] {
+    client->set_connection_timeout(timeouts.connect);
+    client->set_read_timeout(timeouts.read);
+
+    if (limiter_.acquire())
+      ++throttled_;
+    ++requests_;
+    const auto reused = client->is_socket_open();
+    ++(reused ? reused_ : handshakes_);
+
+    return std::pair{request(*client), reused};
+  };
+
+  // The server may have closed an idle keep-alive socket under us, so retry
+  // once on a fresh connection. Orders (including position closes, which
+  // submit one) are only retried if they never left the machine to avoid
+  // submitting them twice
+  const auto exchange = [&] {
+    auto [res, reused] = attempt();
+    const auto retryable =
+        idempotent or res.error() == httplib::Error::Connection or
+        res.error() == httplib::Error::Write;
+    if (not res and reused and retryable) {
+      ++reconnects_;
+      client = std::make_unique<httplib::Client>(host_);
+      client->set_keep_alive(true);
+      res = attempt().first;
+    }
+    return std::move(res);
+  };
+
+  auto res = exchange();
+
+  // A 429 is refused before the server acts on it, so even orders are safe
+  // to resend once every caller has been held back
+  for (auto retry = 0; res and res->status == 429; ++retry) {
+    ++rate_limited_;
+    limiter_.rejected(resume_time(*res, retry));
+    if (retry == max_rate_limit_retries)
+      break;
+    res = exchange();
+  }
+  if (res and res->status != 429)
+    limiter_.accepted(header_number(*res, "X-RateLimit-Limit"));
+
+  // Broken clients are dropped rather than returned to the pool
+  if (res)
+    release(std::move(client));
+
+  return res;
+}
+
+httplib::Result ConnectionPool::get(const std::string &path,
+                                    const httplib::Headers &headers,
+                                    Timeouts timeouts) {
+  return send(timeouts, true, [&](httplib::Client &client) {
+    return client.Get(path, headers);
+  });
+}
+
+httplib::Result ConnectionPool::post(const std::string &path,
+                                     const httplib::Headers &headers,
+                                     const std::string &body,
+                                     const std::string &content_type,
+                                     Timeouts timeouts) {
+  return send(timeouts, false, [&](httplib::Client &client) {
+    return client.Post(path, headers, body, content_type);
+  });
+}
+
+httplib::Result ConnectionPool::del(const std::string &path,
+                                    const httplib::Headers &headers,
+                                    Timeouts timeouts) {
+  // Deleting a position submits a closing order, so not idempotent
+  return send(timeouts, false, [&](httplib::Client &client) {
+    return client.Delete(path, headers);
+  });
+}
+
+ConnectionStats ConnectionPool::stats() const {
+  return {requests_.load(),   handshakes_.load(), reused_.load(),
+          reconnects_.load(), throttled_.load(),  rate_limited_.load()};
+}
@@ -0,0 +1,149 @@
+// Cross-sectional indicator kernels (see cross_section.h)
+
+#include "cross_section.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+#if defined(__x86_64__) or defined(__i386__)
+#define LFT_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr auto lanes = 4uz; // Doubles per AVX2 register
+
+// Each kernel adds a per-symbol sum over rows [first, last) of a time-major
+// matrix into out[0, stride). stride is a multiple of lanes and rows start
+// 64-byte aligned, so the AVX2 versions use aligned loads throughout
+
+void column_sums_scalar(const double *m, std::size_t stride, std::size_t first,
+                        std::size_t last, double *out) {
+  for (auto r = first; r < last; ++r)
+    for (auto s = 0uz; s < stride; ++s)
+      out[s] += m[r * stride + s];
+}
+
+#ifdef LFT_X86_KERNELS
+
+bool has_avx2() {
+  static const auto supported = __builtin_cpu_supports("avx2") != 0;
+  return supported;
+}
+
+// Symbols are the outer loop so each accumulator stays in a register
+// while the window's rows stream past
+
+__attribute__((target("avx2"))) void
+column_sums_avx2(const double *m, std::size_t stride, std::size_t first,
+                 std::size_t last, double *out) {
+  for (auto s = 0uz; s < stride; s += lanes) {
+    auto acc = _mm256_load_pd(out + s);
+    for (auto r = first; r < last; ++r)
+      acc = _mm256_add_pd(acc, _mm256_load_pd(m + r * stride + s));
+    _mm256_store_pd(out + s, acc);
+  }
+}
+
+__attribute__((target("avx2"))) void
+masked_sums_avx2(const double *values, const double *included, std::size_t n,
+                 double *sums, double *counts) {
+  auto sum = _mm256_loadu_pd(sums);
+  auto count = _mm256_loadu_pd(counts);
+  for (auto i = 0uz; i < n; i += lanes) {
+    const auto weight = _mm256_loadu_pd(included + i);
+    sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(values + i), weight));
+    count = _mm256_add_pd(count, weight);
+  }
+  _mm256_storeu_pd(sums, sum);
+  _mm256_storeu_pd(counts, count);
+}
+
+#endif
+
+void column_sums(const double *m, std::size_t stride, std::size_t first,
+                 std::size_t last, double *out) {
+#ifdef LFT_X86_KERNELS
+  if (has_avx2())
+    return column_sums_avx2(m, stride, first, last, out);
+#endif
+  column_sums_scalar(m, stride, first, last, out);
+}
+
+// Zeroed, aligned accumulator row
+auto accumulator(std::size_t stride) {
+  return std::vector<double, AlignedAllocator<double>>(stride, 0.0);
+}
+
+} // anonymous namespace
+
+CrossSection::CrossSection(std::size_t symbols, std::size_t rows)
+    : symbols_{symbols}, stride_{(symbols + lanes - 1) / lanes * lanes},
+      rows_{rows}, volumes_(stride_ * rows_), lengths_(symbols) {}
+
+void CrossSection::load(std::size_t symbol, std::span<const Bar> bars) {
+  assert(symbol < symbols_ && "Symbol index out of range");
+
+  const auto count = std::min(bars.size(), rows_);
+  const auto recent = bars.last(count);
+  const auto first = rows_ - count;
+
+  for (auto r = 0uz; r < rows_; ++r) {
+    const auto i = r * stride_ + symbol;
+    volumes_[i] =
+        r < first ? 0.0 : static_cast<double>(recent[r - first].volume);
+  }
+  lengths_[symbol] = count;
+}
+
+void CrossSection::mask_short(std::vector<double> &values,
+                              std::size_t window) const {
+  for (auto s = 0uz; s < symbols_; ++s)
+    if (lengths_[s] < window)
+      values[s] = 0.0;
+}
+
+std::vector<double> CrossSection::volume_ratio(std::size_t window) const {
+  if (window == 0 or window > rows_)
+    return std::vector<double>(symbols_);
+  auto sums = accumulator(stride_);
+  column_sums(volumes_.data(), stride_, rows_ - window, rows_, sums.data());
+
+  const auto *latest = volumes_.data() + (rows_ - 1) * stride_;
+  auto result = std::vector<double>(symbols_);
+  for (auto s = 0uz; s < symbols_; ++s) {
+    const auto average = sums[s] / static_cast<double>(window);
+    result[s] = average > 0.0 ? latest[s] / average : 0.0;
+  }
+  mask_short(result, window);
+  return result;
+}
+
+std::optional<double> masked_mean(std::span<const double> values,
+                                  std::span<const double> included) {
+  assert(values.size() == included.size() && "Mask must match values");
+
+  // Lane k sums elements k, k + 4, k + 8, ... in order on both paths
+  auto sums = std::array<double, lanes>{};
+  auto counts = std::array<double, lanes>{};
+  const auto whole = values.size() / lanes * lanes;
+  auto i = 0uz;
+
+#ifdef LFT_X86_KERNELS
+  if (has_avx2()) {
+    masked_sums_avx2(values.data(), included.data(), whole, sums.data(),
+                     counts.data());
+    i = whole;
+  }
+#endif
+  for (; i < values.size(); ++i) {
+    sums[i % lanes] += values[i] * included[i];
+    counts[i % lanes] += included[i];
+  }
+
+  const auto count = (counts[0] + counts[1]) + (counts[2] + counts[3]);
+  if (count == 0.0)
+    return std::nullopt;
+  return ((sums[0] + sums[1]) + (sums[2] + sums[3])) / count;
+}
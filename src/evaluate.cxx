@@ -4,12 +4,12 @@
 
 #include "lft.h"
 #include "defs.h"
+#include "market_data_cache.h"
 #include "strategies.h"
 #include <algorithm>
 #include <chrono>
 #include <format>
 #include <map>
-#include <thread>
 #include <numeric>
 #include <print>
 #include <set>
@@ -17,30 +17,24 @@
 #include <vector>
 
 MarketEvaluation evaluate_market(AlpacaClient &client,
-                                  const std::map<std::string, bool> &enabled_strategies,
+                                  const MarketDataCache &market_data,
+                                  StrategyMask enabled_strategies,
                                   const std::set<std::string> &symbols_in_use) {
   auto result = MarketEvaluation{};
 
-  // Build price histories for relative strength (if strategy is enabled)
-  auto price_histories = std::map<std::string, PriceHistory>{};
-  if (enabled_strategies.contains("relative_strength") and enabled_strategies.at("relative_strength")) {
-    for (const auto &symbol : stocks) {
-      if (auto bars = client.get_bars(symbol, "15Min", 100)) {
-        auto &history = price_histories[symbol];
-        for (const auto &bar : *bars) {
-          history.add_bar(bar.close, bar.high, bar.low, bar.volume);
-        }
-        if (not bars->empty()) {
-          history.last_price = bars->back().close;
-          history.has_history = true;
-        }
-      }
-    }
-  }
+  // Market average for relative strength, computed once from the shared cache
+  const auto market = market_data.market_context();
+
+  // One batched snapshot request for the whole watchlist, with any newer
+  // streamed trades/quotes layered on top
+  auto snapshots = fetch_snapshot_map(client, stocks);
+  market_data.overlay_snapshots(snapshots);
+
+  // Volume ratios for the whole watchlist in one cross-sectional pass
+  const auto volume_ratios = market_data.volume_ratios();
 
   auto total_spread_bps = 0.0;
   auto count = 0uz;
-  auto network_failed = false;
 
   // Evaluate each watchlist symbol
   for (const auto &symbol : stocks) {
@@ -50,37 +44,25 @@ MarketEvaluation evaluate_market(AlpacaClient &client,
     // Track if we're in position (but continue to show market data)
     const auto in_position = symbols_in_use.contains(symbol);
 
-    // If network already failed on a previous symbol, don't spam more errors
-    if (network_failed) {
-      eval.status_summary = "Network error";
-      result.symbols.push_back(eval);
-      continue;
-    }
-
-    // Fetch latest bar data and snapshot
-    auto bars_opt = client.get_bars(symbol, "15Min", 100);
-    auto snapshot_opt = client.get_snapshot(symbol);
-
-    // Delay to avoid API rate limiting (100ms = max 600 req/min, well under limit)
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-    if (not bars_opt or not snapshot_opt) {
-      // Log which API call failed for debugging
-      if (not bars_opt and not snapshot_opt)
-        eval.status_summary = "Both APIs failed";
-      else if (not bars_opt)
-        eval.status_summary = "Bars API failed";
+    // Latest bars from the cache, snapshot from the batched fetch above
+    const auto *cached_bars = market_data.bars(symbol);
+    const auto snapshot_it = snapshots.find(symbol);
+    const auto has_snapshot = snapshot_it != snapshots.end();
+
+    if (not cached_bars or not has_snapshot) {
+      // Log which data source is missing for debugging
+      if (not cached_bars and not has_snapshot)
+        eval.status_summary = "No bars or snapshot";
+      else if (not cached_bars)
+        eval.status_summary = "No bars";
       else
-        eval.status_summary = "Snapshot API failed";
+        eval.status_summary = "No snapshot";
 
       result.symbols.push_back(eval);
-      network_failed = true; // Stop trying other symbols to avoid error spam
-      std::println("  ⚠️  {} data fetch failed - stopping further API calls to avoid spam", symbol);
       continue;
     }
 
-    const auto &bars = *bars_opt;
-    const auto &snapshot = *snapshot_opt;
+    const auto &snapshot = snapshot_it->second;
 
     eval.price = snapshot.latest_trade_price;
 
@@ -98,15 +80,9 @@ MarketEvaluation evaluate_market(AlpacaClient &client,
       ++count;
     }
 
-    // Calculate volume ratio (current vs 20-bar average)
-    if (bars.size() >= 20) {
-      auto total_volume = 0.0;
-      for (auto i = bars.size() - 20; i < bars.size(); ++i)
-        total_volume += bars[i].volume;
-      const auto avg_volume = total_volume / 20.0;
-      const auto current_volume = bars.back().volume;
-      eval.volume_ratio = avg_volume > 0.0 ? current_volume / avg_volume : 0.0;
-    }
+    // Volume ratio (current vs 20-bar average, 0 with fewer bars)
+    if (auto it = volume_ratios.find(symbol); it != volume_ratios.end())
+      eval.volume_ratio = it->second;
 
     // Calculate total trading costs
     const auto total_costs_bps = eval.spread_bps + slippage_buffer_bps + adverse_selection_bps;
@@ -120,44 +96,20 @@ MarketEvaluation evaluate_market(AlpacaClient &client,
     const auto volume_ok = eval.volume_ratio >= min_volume_ratio;
     eval.tradeable = spread_ok and volume_ok;
 
-    // Build price history from bars (always evaluate strategies, even if spread/volume issues)
-    auto history = PriceHistory{};
-    for (const auto &bar : bars) {
-      history.add_bar(bar.close, bar.high, bar.low, bar.volume);
-    }
-    history.last_price = snapshot.latest_trade_price;
-    history.has_history = not bars.empty();
-
-    // Evaluate all strategies
-    const auto all_signals = std::vector<StrategySignal>{
-        Strategies::evaluate_ma_crossover(history),
-        Strategies::evaluate_mean_reversion(history),
-        Strategies::evaluate_volatility_breakout(history),
-        Strategies::evaluate_relative_strength(history, price_histories),
-        Strategies::evaluate_volume_surge(history)
-    };
-
-    // Check each enabled strategy
-    for (const auto &[strategy_name, is_enabled] : enabled_strategies) {
-      if (not is_enabled) {
-        eval.strategy_signals[strategy_name] = false;
-        continue;
-      }
-
-      // Check if this strategy fired
-      const auto has_signal = std::ranges::any_of(all_signals, [&](const auto &sig) {
-        return sig.should_buy and sig.strategy_name == strategy_name;
-      });
+    // Evaluate all strategies from the cache's per-symbol state (always,
+    // even if spread/volume issues)
+    const auto &history = market_data.histories().at(symbol);
+    const auto all_signals =
+        market_data.strategies(symbol)->signals(history, market);
 
-      eval.strategy_signals[strategy_name] = has_signal;
-      if (has_signal)
-        ++result.total_signals;
-    }
+    // Record which enabled strategies fired (signals are indexed by ID)
+    for (auto id = 0uz; id < strategy_count; ++id)
+      eval.strategy_signals.set(id, enabled_strategies.test(id) and
+                                        all_signals[id].should_buy);
 
     // Build status summary and ready-to-trade flag
-    const auto signal_count = std::ranges::count_if(eval.strategy_signals, [](const auto &p) {
-      return p.second;
-    });
+    const auto signal_count = eval.strategy_signals.count();
+    result.total_signals += signal_count;
 
     eval.ready_to_trade = eval.tradeable and signal_count > 0 and not in_position;
 
@@ -197,7 +149,7 @@ MarketEvaluation evaluate_market(AlpacaClient &client,
 }
 
 void display_evaluation(const MarketEvaluation &eval,
-                       const std::map<std::string, bool> &enabled_strategies,
+                       StrategyMask enabled_strategies,
                        std::chrono::system_clock::time_point now) {
   // Calculate market breadth
   const auto advancing = std::ranges::count_if(eval.symbols, [](const auto &s) {
@@ -220,12 +172,6 @@ void display_evaluation(const MarketEvaluation &eval,
   std::println("  Active signals:    {}", eval.total_signals);
   std::println("  Market breadth:    {}/{} advancing", advancing, symbols_with_data);
 
-  // Build strategy name list for header
-  auto strategy_names = std::vector<std::string>{};
-  for (const auto &[name, enabled] : enabled_strategies)
-    if (enabled)
-      strategy_names.push_back(name);
-
   // Only show table if we have data for some symbols
   if (symbols_with_data > 0) {
     std::println("\n  Symbol   Price    Spread  Edge   Vol    Strategies  Ready  Status");
@@ -237,14 +183,12 @@ void display_evaluation(const MarketEvaluation &eval,
       if (s.price == 0.0)
         continue;
 
-      // Build strategy indicator string (✓ or ✗ for each strategy)
+      // Build strategy indicator string (✓ or ✗ for each enabled strategy)
       auto strategy_str = std::string{};
-      for (const auto &name : strategy_names) {
-        if (s.strategy_signals.contains(name)) {
-          strategy_str += s.strategy_signals.at(name) ? "✓" : "✗";
-        } else {
-          strategy_str += "-";
-        }
+      for (auto id = 0uz; id < strategy_count; ++id) {
+        if (not enabled_strategies.test(id))
+          continue;
+        strategy_str += s.strategy_signals.test(id) ? "✓" : "✗";
         strategy_str += " ";
       }
 
@@ -257,7 +201,7 @@ void display_evaluation(const MarketEvaluation &eval,
 
   // Show error summary if any symbols failed
   if (symbols_with_errors > 0) {
-    std::println("\n  ⚠️  {} symbol(s) had data fetch errors (stopped early to avoid API spam)", symbols_with_errors);
+    std::println("\n  ⚠️  {} symbol(s) had no bars or snapshot this cycle", symbols_with_errors);
     std::println("      Entry checking will continue for individual symbols that succeed");
   }
 }
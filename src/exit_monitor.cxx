@@ -0,0 +1,64 @@
+#include "exit_monitor.h"
+#include "defs.h"
+#include "latency.h"
+#include <algorithm>
+#include <print>
+
+ExitMonitor::ExitMonitor(AlpacaClient &client,
+                         std::chrono::system_clock::time_point eod)
+    : client_{client}, eod_{eod},
+      thread_{[this](std::stop_token stop) { run(stop); }} {}
+
+std::vector<ExitNotice> ExitMonitor::take_notices() {
+  auto notices = std::vector<ExitNotice>{};
+  while (auto notice = notices_.try_pop())
+    notices.push_back(std::move(*notice));
+  return notices;
+}
+
+void ExitMonitor::run(std::stop_token stop) {
+  using namespace std::chrono;
+  static auto &latency = latency_histogram("phase.check_panic_exits");
+  constexpr auto interval = milliseconds{exit_monitor_interval_ms};
+
+  auto lock = std::unique_lock{mutex_};
+  auto next_check = steady_clock::now();
+
+  while (not stop.stop_requested()) {
+    const auto now = system_clock::now();
+
+    // While the market is closed, sleep until today's open; once it has
+    // passed there is nothing to check until the monitor is stopped
+    if (not is_market_hours(now)) {
+      if (const auto open = market_open_time(now); now < open) {
+        next_check = steady_clock::now() +
+                     duration_cast<steady_clock::duration>(open - now);
+        cv_.wait_until(lock, stop, next_check, [] { return false; });
+      } else {
+        cv_.wait(lock, stop, [] { return false; });
+      }
+      continue;
+    }
+
+    {
+      const auto timer = ScopedTimer{latency};
+      for (auto &notice : check_panic_exits(client_, now, eod_))
+        if (not notices_.try_push(notice))
+          report_exits({notice}); // Queue full: report it here instead
+    }
+
+    // Fixed cadence; a check that overruns is followed straight away
+    next_check = std::max(next_check + interval, steady_clock::now());
+    cv_.wait_until(lock, stop, next_check, [] { return false; });
+  }
+}
+
+void report_exits(const std::vector<ExitNotice> &notices) {
+  for (const auto &notice : notices) {
+    std::println("🚨 {} at {:%H:%M:%S}: {} ${:.2f} ({:+.2f}%) {}",
+                 notice.reason,
+                 std::chrono::floor<std::chrono::seconds>(notice.at),
+                 notice.symbol, notice.unrealized_pl, notice.pl_pct * 100.0,
+                 notice.closed ? "✅ closed" : "❌ close failed");
+  }
+}
@@ -1,15 +1,8 @@
 // Global state for position tracking across phases
-// These maps persist across check_entries and check_exits calls
+// Shared by the strategy thread (check_entries, check_normal_exits) and the
+// exit monitor thread (check_panic_exits)
 
-#include <chrono>
-#include <map>
-#include <string>
+#include "position_book.h"
 
-// Track which strategy entered each position
-std::map<std::string, std::string> position_strategies;
-
-// Track peak prices for trailing stop loss
-std::map<std::string, double> position_peaks;
-
-// Track when each position was entered
-std::map<std::string, std::chrono::system_clock::time_point> position_entry_times;
+// Entry strategy, entry time and trailing peak of each position
+PositionBook position_book;
@@ -0,0 +1,103 @@
+#include "latency.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <print>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+// Histograms live in a deque so references stay valid as more are added
+struct LatencyRegistry {
+  std::mutex mutex;
+  std::deque<std::pair<std::string, LatencyHistogram>> histograms;
+};
+
+LatencyRegistry &registry() {
+  static auto instance = LatencyRegistry{};
+  return instance;
+}
+
+double to_ms(std::chrono::nanoseconds ns) {
+  return std::chrono::duration<double, std::milli>(ns).count();
+}
+
+} // anonymous namespace
+
+void LatencyHistogram::record(std::chrono::nanoseconds elapsed) {
+  const auto ns =
+      static_cast<std::uint64_t>(std::max<std::int64_t>(elapsed.count(), 0));
+  buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+
+  auto max = max_.load(std::memory_order_relaxed);
+  while (ns > max and
+         not max_.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+    ;
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const {
+  return std::chrono::nanoseconds{
+      static_cast<std::int64_t>(max_.load(std::memory_order_relaxed))};
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double pct) const {
+  const auto total = count();
+  if (total == 0)
+    return {};
+
+  // Rank of the sample at the percentile (1-based)
+  const auto rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(
+             std::ceil(pct / 100.0 * static_cast<double>(total))));
+
+  auto seen = std::uint64_t{};
+  for (auto i = 0uz; i < bucket_count; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return std::min(max(), std::chrono::nanoseconds{
+                                 static_cast<std::int64_t>(bucket_upper(i))});
+  }
+  return max();
+}
+
+void LatencyHistogram::reset() {
+  for (auto &bucket : buckets_)
+    bucket.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram &latency_histogram(std::string_view name) {
+  auto &reg = registry();
+  auto lock = std::lock_guard{reg.mutex};
+
+  for (auto &[existing, histogram] : reg.histograms)
+    if (existing == name)
+      return histogram;
+
+  return reg.histograms
+      .emplace_back(std::piecewise_construct, std::forward_as_tuple(name),
+                    std::forward_as_tuple())
+      .second;
+}
+
+void print_latency_report() {
+  auto &reg = registry();
+  auto lock = std::lock_guard{reg.mutex};
+
+  std::println("\n⏱️  Latency (ms):");
+  std::println("  {:<32} {:>7} {:>10} {:>10} {:>10}", "", "Count", "p50", "p99",
+               "Max");
+
+  for (const auto &[name, histogram] : reg.histograms) {
+    if (histogram.count() == 0)
+      continue;
+    std::println("  {:<32} {:>7} {:>10.3f} {:>10.3f} {:>10.3f}", name,
+                 histogram.count(), to_ms(histogram.percentile(50.0)),
+                 to_ms(histogram.percentile(99.0)), to_ms(histogram.max()));
+  }
+}
@@ -2,29 +2,52 @@
 // Shared state, data fetching, and timing functions
 
 #include "lft.h"
+#include "bar_store.h"
 #include "defs.h"
 #include "strategies.h"
+#include "timestamps.h"
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <format>
 #include <map>
+#include <optional>
 #include <print>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 // ═══════════════════════════════════════════════════════════════════════
 // DATA FETCHING AND ASSESSMENT
 // ═══════════════════════════════════════════════════════════════════════
 
+std::map<std::string, Snapshot>
+fetch_snapshot_map(AlpacaClient &client,
+                   const std::vector<std::string> &symbols) {
+  if (symbols.empty())
+    return {};
+
+  // One batched request per chunk of symbols instead of one per symbol
+  auto result = client.get_snapshots(symbols);
+  if (not result) {
+    std::println("  ⚠️  Snapshot fetch failed for {} symbols", symbols.size());
+    return {};
+  }
+
+  return *result;
+}
+
 std::vector<Snapshot> fetch_snapshots(AlpacaClient &client) {
   auto snapshots = std::vector<Snapshot>{};
+  const auto snapshot_map = fetch_snapshot_map(client, stocks);
 
-  for (const auto &symbol : stocks) {
-    if (auto snapshot = client.get_snapshot(symbol))
-      snapshots.push_back(*snapshot);
-  }
+  // Keep watchlist order
+  for (const auto &symbol : stocks)
+    if (auto it = snapshot_map.find(symbol); it != snapshot_map.end())
+      snapshots.push_back(it->second);
 
   return snapshots;
 }
@@ -51,11 +74,23 @@ assess_market_conditions(AlpacaClient &client,
   // Sparkline characters (from lowest to highest)
   constexpr auto sparks = std::array{"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
 
-  for (const auto &snap : snapshots) {
+  // Recent 1-minute bars for every quoted symbol's sparkline (1 day = enough
+  // for 10 recent bars), fetched concurrently
+  const auto has_quote = [](const Snapshot &snap) {
+    return snap.latest_quote_bid > 0.0 and snap.latest_quote_ask > 0.0;
+  };
+  const auto recent_bars = client.fan_out(snapshots.size(), [&](std::size_t i) {
+    return has_quote(snapshots[i])
+               ? client.get_bars(snapshots[i].symbol, "1Min", 1)
+               : std::nullopt;
+  });
+
+  for (auto snap_idx = 0uz; snap_idx < snapshots.size(); ++snap_idx) {
+    const auto &snap = snapshots[snap_idx];
     const auto bid = snap.latest_quote_bid;
     const auto ask = snap.latest_quote_ask;
 
-    if (bid > 0.0 and ask > 0.0) {
+    if (has_quote(snap)) {
       const auto spread_bps = ((ask - bid) / bid) * 10000.0;
       total_spread_bps += spread_bps;
       ++count;
@@ -67,10 +102,8 @@ assess_market_conditions(AlpacaClient &client,
                     100.0
               : 0.0;
 
-      // Fetch recent 1-minute bars for sparkline (1 day = enough for 10 recent
-      // bars)
       auto sparkline = std::string{};
-      if (auto all_bars = client.get_bars(snap.symbol, "1Min", 1)) {
+      if (const auto &all_bars = recent_bars[snap_idx]) {
         // Debug: Log bar count for first symbol only to avoid spam
         static auto first_log = true;
         if (first_log) {
@@ -172,19 +205,77 @@ assess_market_conditions(AlpacaClient &client,
 }
 
 std::map<std::string, std::vector<Bar>> fetch_bars(AlpacaClient &client) {
-  auto all_bars = std::map<std::string, std::vector<Bar>>{};
-
   std::println("  Fetching {} days of 15-min bars for {} symbols...",
                calibration_days, stocks.size());
 
-  auto fetched = 0uz;
+  using namespace std::chrono;
+  const auto now_ns = duration_cast<nanoseconds>(
+                          floor<seconds>(system_clock::now()).time_since_epoch())
+                          .count();
+  const auto window_start_ns =
+      now_ns - calibration_days * ns_per_day;
+
+  // Start from the on-disk cache so a restart only downloads the new bars
+  const auto store = BarStore{bar_cache_dir};
+  auto all_bars = std::map<std::string, std::vector<Bar>>{};
+  auto cached = std::vector<std::string>{};
+  auto uncached = std::vector<std::string>{};
+  auto delta_start_ns = now_ns;
+
   for (const auto &symbol : stocks) {
-    if (auto bars = client.get_bars(symbol, "15Min", calibration_days)) {
-      all_bars[symbol] = *bars;
-      ++fetched;
-      std::println("    {}/{}: {} ({} bars)", fetched, stocks.size(), symbol,
-                   bars->size());
+    auto bars = store.load(symbol, "15Min", window_start_ns, now_ns + 1);
+    if (bars.empty()) {
+      uncached.push_back(symbol);
+      continue;
     }
+
+    // Refetch from the last cached bar (inclusive) so Alpaca's revised
+    // version of it overwrites the cached copy
+    delta_start_ns = std::min(delta_start_ns, bars.back().timestamp);
+    cached.push_back(symbol);
+    all_bars[symbol] = std::move(bars);
+  }
+
+  std::println("  Cache: {} symbols cached, {} to download", cached.size(),
+               uncached.size());
+
+  // A few paged multi-symbol requests instead of one request per symbol,
+  // with the full-window and delta groups fetched concurrently
+  const auto end = format_timestamp(now_ns);
+  const auto groups = std::array{std::pair{&uncached, window_start_ns},
+                                 std::pair{&cached, delta_start_ns}};
+  auto fresh = client.fan_out(groups.size(), [&](std::size_t i) {
+    const auto &[symbols, start_ns] = groups[i];
+    return symbols->empty()
+               ? std::map<std::string, std::vector<Bar>>{}
+               : client.get_multi_bars(*symbols, "15Min",
+                                       format_timestamp(start_ns), end);
+  });
+
+  for (auto i = 0uz; i < groups.size(); ++i) {
+    if (not fresh[i]) {
+      std::println("  ⚠️  Bar fetch failed for {} symbols",
+                   groups[i].first->size());
+      continue;
+    }
+
+    for (const auto &[symbol, bars] : *fresh[i])
+      merge_bars(all_bars[symbol], bars);
+  }
+
+  // Keep only the calibration window and write back the updated series
+  auto fetched = 0uz;
+  for (const auto &symbol : stocks) {
+    auto it = all_bars.find(symbol);
+    if (it == all_bars.end())
+      continue;
+
+    trim_bars(it->second, window_start_ns);
+    store.save(symbol, "15Min", it->second);
+
+    ++fetched;
+    std::println("    {}/{}: {} ({} bars)", fetched, stocks.size(), symbol,
+                 it->second.size());
   }
 
   return all_bars;
@@ -225,12 +316,24 @@ next_15_minute_bar(std::chrono::system_clock::time_point now) {
 }
 
 std::chrono::system_clock::time_point
-next_minute_at_35_seconds(std::chrono::system_clock::time_point now) {
-  const auto now_t = std::chrono::system_clock::to_time_t(now);
-  auto tm = *std::localtime(&now_t);
-  tm.tm_sec = 35;
-  tm.tm_min += 1;
-  return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+next_whole_minute(std::chrono::system_clock::time_point now) {
+  return std::chrono::floor<std::chrono::minutes>(now) + std::chrono::minutes{1};
+}
+
+std::chrono::system_clock::time_point
+market_open_time(std::chrono::system_clock::time_point now) {
+  using namespace std::chrono;
+
+  // Convert current time to Eastern Time
+  const auto et_now = zoned_time{"America/New_York", now};
+
+  // Get the date in ET and construct 9:30 AM ET
+  const auto et_local = et_now.get_local_time();
+  const auto et_date = floor<days>(et_local);
+  const auto open_time_et = et_date + 9h + 30min; // 9:30 AM ET
+
+  // Convert back to system_clock::time_point (UTC)
+  return zoned_time{"America/New_York", open_time_et}.get_sys_time();
 }
 
 std::chrono::system_clock::time_point
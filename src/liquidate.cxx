@@ -4,6 +4,13 @@
 #include "lft.h"
 #include <print>
 
+std::vector<std::expected<std::string, AlpacaError>>
+close_positions(AlpacaClient &client, const std::vector<Position> &positions) {
+  return client.fan_out(positions.size(), [&](std::size_t i) {
+    return client.close_position(positions[i].symbol);
+  });
+}
+
 void liquidate_all(AlpacaClient &client) {
   const auto positions = client.get_positions();
 
@@ -12,8 +19,7 @@ void liquidate_all(AlpacaClient &client) {
     return;
   }
 
-  for (const auto &pos : positions) {
+  for (const auto &pos : positions)
     std::println("  Liquidating {} ({} shares)", pos.symbol, pos.qty);
-    client.close_position(pos.symbol);
-  }
+  close_positions(client, positions);
 }
@@ -1,16 +1,44 @@
 #include "lft.h"
+#include "defs.h"
+#include "exit_monitor.h"
+#include "latency.h"
+#include "market_data_cache.h"
+#include "market_stream.h"
+#include "scheduler.h"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <print>
 #include <set>
+#include <string_view>
 #include <thread>
 
 // LFT - Low Frequency Trader
+// Usage: lft [--threads N] [--sweep]
+//   --threads N  Calibration threads (default one per core)
+//   --sweep      Rank exit-threshold combinations on the calibration bars,
+//                then exit without trading
 
-int main() {
+int main(int argc, char *argv[]) {
   std::println("🚀 LFT - Low Frequency Trader V2");
   using namespace std::chrono_literals;
 
+  auto threads = std::max(1u, std::thread::hardware_concurrency());
+  auto sweep = false;
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--threads" and i + 1 < argc) {
+      threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+    } else if (arg == "--sweep") {
+      sweep = true;
+    } else {
+      std::println(stderr, "Usage: {} [--threads N] [--sweep]", argv[0]);
+      return 1;
+    }
+  }
+
   // Create connection to exchange
   auto client = AlpacaClient{};
 
@@ -27,18 +55,57 @@ int main() {
 
   // Calibrate strategies using historic data with fixed starting capital
   constexpr auto backtest_capital = 100000.0;
-  std::println("🎯 Calibrating strategies with ${:.2f} starting capital...",
-               backtest_capital);
-  const auto enabled_strategies = calibrate(bars, backtest_capital);
 
-  // Create intervals
-  auto next_entry = next_15_minute_bar(session_start);
-  auto next_exit = next_minute_at_35_seconds(session_start);
-  auto liquidated = false;
+  // Tuning mode: rank exit thresholds on the same bars instead of trading
+  if (sweep) {
+    sweep_exit_params(bars, backtest_capital, threads);
+    return 0;
+  }
 
-  for (auto now = std::chrono::system_clock::now(); now < session_end;
-       now = std::chrono::system_clock::now()) {
+  std::println("🎯 Calibrating strategies with ${:.2f} starting capital...",
+               backtest_capital);
+  const auto enabled_strategies = calibrate(bars, backtest_capital, threads);
+
+  // Live bar series shared by evaluation and entries, seeded from the
+  // calibration bars so each cycle only fetches what's new
+  auto market_data = MarketDataCache{stocks};
+  market_data.seed(bars);
+
+  // Optional push-based feed (LFT_STREAM_URL=host:port, see market_stream.h)
+  auto stream = std::unique_ptr<MarketStream>{};
+  if (const auto *stream_url = std::getenv("LFT_STREAM_URL")) {
+    std::println("📡 Streaming market data from {}", stream_url);
+    stream = std::make_unique<MarketStream>(stream_url, stocks);
+  }
 
+  // Per-phase latency (see latency.h), reported when the session ends
+  auto &cycle_latency = latency_histogram("phase.cycle");
+  auto &account_latency = latency_histogram("phase.account_summary");
+  auto &market_data_latency = latency_histogram("phase.market_data");
+  auto &evaluate_latency = latency_histogram("phase.evaluate_market");
+  auto &entries_latency = latency_histogram("phase.check_entries");
+  auto &normal_exits_latency = latency_histogram("phase.check_normal_exits");
+
+  // While the market is closed, tasks wait for today's open; once it has
+  // passed they retire until the next session
+  const auto market_open = market_open_time(session_start);
+  const auto until_open = [market_open](auto now) {
+    return now < market_open ? market_open : Scheduler::never();
+  };
+
+  // Panic stops and EOD liquidation run on their own thread from here on
+  auto exit_monitor = ExitMonitor{client, eod};
+
+  // Strategy cycle deadline; evaluation refetches bars when one is due so
+  // entries see Alpaca's revised bars
+  auto next_cycle = next_15_minute_bar(session_start);
+
+  // Tasks due at the same time run in the order added: status, evaluation,
+  // strategy cycle
+  auto scheduler = Scheduler{};
+
+  // Status and account summary every minute
+  scheduler.add("status", session_start, [&](auto now) {
     const auto remaining =
         std::chrono::duration_cast<std::chrono::minutes>(session_end - now);
     std::println(
@@ -47,35 +114,33 @@ int main() {
         std::chrono::floor<std::chrono::seconds>(session_end),
         remaining.count());
 
+    // Exits the monitor made since the last status
+    report_exits(exit_monitor.take_notices());
+
     // Display next scheduled event times
     std::println("\n⏰ Next Events:");
-    std::println("  Strategy Cycle:  {:%H:%M:%S}  (entries + TP/SL/trailing)",
-                 std::chrono::floor<std::chrono::seconds>(next_entry));
-    std::println(
-        "  Panic Check:     {:%H:%M:%S}  (panic stops + EOD liquidation)",
-        std::chrono::floor<std::chrono::seconds>(next_exit));
+    for (const auto &[name, deadline] : scheduler.upcoming(now))
+      std::println("  {:<16} {:%H:%M:%S}", name,
+                   std::chrono::floor<std::chrono::seconds>(deadline));
 
     // Display balances and positions
-    display_account_summary(client);
-
-    // Check market hours
-    const auto is_closed = not is_market_hours(now);
-    const auto risk_off = now < trading_start;
+    {
+      const auto timer = ScopedTimer{account_latency};
+      display_account_summary(client);
+    }
 
-    if (is_closed) {
+    if (not is_market_hours(now)) {
       std::println("\n📊 Market: CLOSED");
-    } else if (risk_off) {
+      return until_open(now);
+    }
+
+    if (now < trading_start) {
       std::println("\n📊 Market: OPEN (Risk-off until {:%H:%M:%S} ET)",
                    std::chrono::floor<std::chrono::seconds>(trading_start));
     } else {
       std::println("\n📊 Market: OPEN (Trading active)");
     }
 
-    if (is_closed or liquidated) {
-      std::this_thread::sleep_for(1min);
-      continue;
-    }
-
     // Show time until EOD cutoff
     const auto time_until_close = eod - now;
     const auto hours =
@@ -84,6 +149,14 @@ int main() {
         time_until_close - hours);
     std::println("📈 Market open - EOD cutoff in {}h {}min", hours.count(),
                  minutes.count());
+    return next_whole_minute(now);
+  });
+
+  // Evaluate market every minute (shows prices, spreads, and strategy
+  // signals)
+  scheduler.add("evaluation", session_start, [&](auto now) {
+    if (not is_market_hours(now))
+      return until_open(now);
 
     // Get current positions for evaluation
     auto positions = client.get_positions();
@@ -91,37 +164,89 @@ int main() {
     for (const auto &pos : positions)
       symbols_in_use.insert(pos.symbol);
 
-    // Evaluate market every minute (shows prices, spreads, and strategy
-    // signals)
-    auto evaluation =
-        evaluate_market(client, enabled_strategies, symbols_in_use);
-    display_evaluation(evaluation, enabled_strategies, now);
-
-    // Check panic exits every minute at :35 (fast reaction to all emergency
-    // conditions)
-    if (now >= next_exit) {
-      check_panic_exits(client, now, eod);
-      next_exit = next_minute_at_35_seconds(now);
+    // Poll REST for new bars when not streaming, and on each strategy cycle
+    // so Alpaca's revised bars replace streamed ones
+    if (not stream or now >= next_cycle) {
+      const auto timer = ScopedTimer{market_data_latency};
+      market_data.refresh(client);
     }
 
-    // Execute entry trades every 15 minutes (aligned to :00, :15, :30, :45)
-    // Risk-off before 10:00 AM ET (opening volatility period)
-    // Also check normal exits (TP/SL/trailing) at same frequency as entries
-    if (now >= next_entry) {
-      const auto risk_off = now < trading_start;
-      if (not risk_off) {
-        std::println("\n💼 Executing entry trades at {:%H:%M:%S}",
-                     std::chrono::floor<std::chrono::seconds>(now));
-        check_entries(client, enabled_strategies);
-      } else {
-        std::println("\n⚠️  Risk-off: No entries until {:%H:%M:%S}",
-                     std::chrono::floor<std::chrono::seconds>(trading_start));
-      }
+    auto evaluation = [&] {
+      const auto timer = ScopedTimer{evaluate_latency};
+      return evaluate_market(client, market_data, enabled_strategies,
+                             symbols_in_use);
+    }();
+    display_evaluation(evaluation, enabled_strategies, now);
+    return next_whole_minute(now);
+  });
+
+  // Execute entry trades every 15 minutes (aligned to :00, :15, :30, :45)
+  // Risk-off before 10:00 AM ET (opening volatility period)
+  // Also check normal exits (TP/SL/trailing) at same frequency as entries
+  scheduler.add("strategy_cycle", next_cycle, [&](auto now) {
+    if (not is_market_hours(now))
+      return next_cycle = until_open(now);
+
+    if (now >= trading_start) {
+      std::println("\n💼 Executing entry trades at {:%H:%M:%S}",
+                   std::chrono::floor<std::chrono::seconds>(now));
+      const auto timer = ScopedTimer{entries_latency};
+      check_entries(client, market_data, enabled_strategies);
+    } else {
+      std::println("\n⚠️  Risk-off: No entries until {:%H:%M:%S}",
+                   std::chrono::floor<std::chrono::seconds>(trading_start));
+    }
+    {
+      const auto timer = ScopedTimer{normal_exits_latency};
       check_normal_exits(client, now);
-      next_entry = next_15_minute_bar(now);
     }
+    return next_cycle = next_15_minute_bar(now);
+  });
+
+  std::println("\n🔄 Starting event loop until {:%H:%M:%S}",
+               std::chrono::floor<std::chrono::seconds>(session_end));
+
+  while (true) {
+    // Sleep until the next task is due; streamed updates are applied as they
+    // arrive in the meantime
+    const auto deadline = std::min(scheduler.next_deadline(), session_end);
+    if (stream) {
+      while (stream->wait_until(deadline))
+        stream->drain(market_data);
+    } else {
+      std::this_thread::sleep_until(deadline);
+    }
+
+    const auto now = std::chrono::system_clock::now();
+    if (now >= session_end)
+      break;
+
+    // Work done for this deadline; an overrunning cycle delays the next
+    const auto cycle_start = std::chrono::steady_clock::now();
+    if (scheduler.run_due(now) == 0)
+      continue;
+
+    const auto cycle_time = std::chrono::steady_clock::now() - cycle_start;
+    cycle_latency.record(cycle_time);
+    if (cycle_time > 1min)
+      std::println("\n⚠️  Cycle took {:.1f}s (see latency report at exit)",
+                   std::chrono::duration<double>(cycle_time).count());
   }
 
+  report_exits(exit_monitor.take_notices());
+
+  // Show how many requests reused a keep-alive connection
+  std::println("\n🔌 Connections:");
+  for (const auto &[host, stats] :
+       {std::pair{"Trading", client.trading_connection_stats()},
+        std::pair{"Data", client.data_connection_stats()}})
+    std::println("  {:8} {} requests, {} handshakes, {} reused, {} reconnects, "
+                 "{} throttled, {} rate limited",
+                 host, stats.requests, stats.handshakes, stats.reused,
+                 stats.reconnects, stats.throttled, stats.rate_limited);
+
+  print_latency_report();
+
   std::println("\n✅ Session complete - exiting for restart");
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+// Market data cache shared across the minute cycle
+// Keeps the latest 15-minute bars per symbol and appends only new ones
+
+#include "market_data_cache.h"
+#include "bar_store.h"
+#include "cross_section.h"
+#include "defs.h"
+#include "timestamps.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <print>
+#include <span>
+#include <utility>
+
+namespace {
+
+constexpr auto bucket_ns = 15 * ns_per_minute; // Length of a cached bar
+
+// Apply one bar to a symbol's history and strategy state
+void feed(PriceHistory &history, StrategySet &strategies, const Bar &bar) {
+  history.add_bar(bar.close, bar.high, bar.low, bar.volume);
+  strategies.on_bar(history);
+  history.last_price = bar.close;
+  history.has_history = true;
+}
+
+} // anonymous namespace
+
+MarketDataCache::MarketDataCache(std::vector<std::string> symbols,
+                                 std::size_t max_bars)
+    : symbols_{std::move(symbols)}, max_bars_{max_bars},
+      volumes_{symbols_.size(), volume_ratio_bars} {}
+
+void MarketDataCache::seed(
+    const std::map<std::string, std::vector<Bar>> &all_bars) {
+  for (const auto &symbol : symbols_) {
+    auto it = all_bars.find(symbol);
+    if (it == all_bars.end())
+      continue;
+
+    // Only the most recent bars are needed for live signals
+    const auto &bars = it->second;
+    const auto first = bars.size() > max_bars_ ? bars.size() - max_bars_ : 0uz;
+    bars_[symbol].assign(bars.begin() + static_cast<std::ptrdiff_t>(first),
+                         bars.end());
+    if (not bars.empty())
+      covered_until_[symbol] = bars.back().timestamp + bucket_ns;
+  }
+
+  rebuild_histories();
+}
+
+bool MarketDataCache::refresh(AlpacaClient &client) {
+  using namespace std::chrono;
+  const auto now_ns = duration_cast<nanoseconds>(
+                          floor<seconds>(system_clock::now()).time_since_epoch())
+                          .count();
+
+  // Each symbol is fetched from its own last held bar (symbols with nothing
+  // held backfill the calibration window), one request per distinct start,
+  // so an empty, halted or lagging symbol doesn't widen the fetch for the
+  // rest of the watchlist. Normally every held symbol shares one start
+  auto by_start = std::map<std::int64_t, std::vector<std::string>>{};
+  for (const auto &symbol : symbols_) {
+    auto it = bars_.find(symbol);
+    const auto start_ns = it == bars_.end() or it->second.empty()
+                              ? now_ns - calibration_days * ns_per_day
+                              : it->second.back().timestamp;
+    by_start[start_ns].push_back(symbol);
+  }
+  const auto groups = std::vector(by_start.begin(), by_start.end());
+
+  const auto end = format_timestamp(now_ns);
+  auto fresh = client.fan_out(groups.size(), [&](std::size_t i) {
+    const auto &[start_ns, symbols] = groups[i];
+    return client.get_multi_bars(symbols, "15Min", format_timestamp(start_ns),
+                                 end);
+  });
+
+  auto ok = true;
+  for (auto i = 0uz; i < groups.size(); ++i) {
+    if (not fresh[i]) {
+      std::println("  ⚠️  Market data refresh failed for {} symbols - using "
+                   "cached bars",
+                   groups[i].second.size());
+      ok = false;
+      continue;
+    }
+
+    // Only symbols that received bars need their state replayed
+    for (const auto &[symbol, new_bars] : *fresh[i]) {
+      if (new_bars.empty())
+        continue;
+
+      auto &bars = bars_[symbol];
+      merge_bars(bars, new_bars);
+
+      if (bars.size() > max_bars_)
+        bars.erase(bars.begin(),
+                   bars.end() - static_cast<std::ptrdiff_t>(max_bars_));
+
+      // The last bar fetched holds every trade up to now
+      covered_until_[symbol] =
+          std::min(bars.back().timestamp + bucket_ns, now_ns);
+
+      update_symbol(symbol, new_bars.front().timestamp);
+    }
+  }
+
+  return ok;
+}
+
+void MarketDataCache::apply_bar(const std::string &symbol, const Bar &bar) {
+  const auto bar_ns = bar.timestamp;
+  if (bar_ns == 0)
+    return;
+
+  // Minutes the bars held already include would be counted twice
+  auto &covered_until = covered_until_[symbol];
+  if (bar_ns < covered_until)
+    return;
+
+  // Stream bars are 1-minute; fold them into the 15-minute bucket they
+  // belong to so the series matches what refresh() fetches
+  const auto bucket = bar_ns - bar_ns % bucket_ns;
+
+  auto &bars = bars_[symbol];
+  if (not bars.empty() and bucket < bars.back().timestamp)
+    return;
+
+  if (not bars.empty() and bars.back().timestamp == bucket) {
+    auto &last = bars.back();
+    last.high = std::max(last.high, bar.high);
+    last.low = std::min(last.low, bar.low);
+    last.close = bar.close;
+    last.volume += bar.volume;
+  } else {
+    auto bucket_bar = bar;
+    bucket_bar.timestamp = bucket;
+    bars.push_back(bucket_bar);
+
+    if (bars.size() > max_bars_)
+      bars.erase(bars.begin());
+  }
+  covered_until = bar_ns + ns_per_minute;
+
+  update_symbol(symbol, bucket);
+}
+
+void MarketDataCache::apply_quote(const std::string &symbol, double bid,
+                                  double ask, std::int64_t timestamp) {
+  auto &live = live_[symbol];
+  live.bid = bid;
+  live.ask = ask;
+  live.quote_timestamp = timestamp;
+}
+
+void MarketDataCache::apply_trade(const std::string &symbol, double price,
+                                  std::int64_t timestamp) {
+  auto &live = live_[symbol];
+  live.price = price;
+  live.trade_timestamp = timestamp;
+}
+
+void MarketDataCache::overlay_snapshots(
+    std::map<std::string, Snapshot> &snapshots) const {
+  // REST snapshots carry no quote time, so streamed quotes win if newer than
+  // the snapshot's trade
+  for (auto &[symbol, snap] : snapshots) {
+    auto it = live_.find(symbol);
+    if (it == live_.end())
+      continue;
+
+    const auto &live = it->second;
+    const auto rest_time = snap.latest_trade_timestamp;
+
+    if (live.trade_timestamp > rest_time) {
+      snap.latest_trade_price = live.price;
+      snap.latest_trade_timestamp = live.trade_timestamp;
+    }
+
+    if (live.quote_timestamp > rest_time) {
+      snap.latest_quote_bid = live.bid;
+      snap.latest_quote_ask = live.ask;
+    }
+  }
+}
+
+const std::vector<Bar> *MarketDataCache::bars(std::string_view symbol) const {
+  auto it = bars_.find(symbol);
+  return it == bars_.end() or it->second.empty() ? nullptr : &it->second;
+}
+
+PriceHistory MarketDataCache::history(std::string_view symbol) const {
+  auto it = histories_.find(std::string{symbol});
+  return it == histories_.end() ? PriceHistory{} : it->second;
+}
+
+const StrategySet *MarketDataCache::strategies(std::string_view symbol) const {
+  auto it = strategy_sets_.find(symbol);
+  return it == strategy_sets_.end() ? nullptr : &it->second;
+}
+
+MarketContext MarketDataCache::market_context() const {
+  // Same masked mean as the backtest's per-bar market average, so live and
+  // backtest relative strength see the same figure
+  auto changes = std::vector<double>{};
+  auto has_change = std::vector<double>{};
+  changes.reserve(histories_.size());
+  has_change.reserve(histories_.size());
+  for (const auto &[symbol, history] : histories_) {
+    changes.push_back(history.change_percent);
+    has_change.push_back(history.has_history ? 1.0 : 0.0);
+  }
+  return MarketContext{.average_change = masked_mean(changes, has_change)};
+}
+
+void MarketDataCache::load_volumes(std::string_view symbol) {
+  const auto column = std::ranges::find(symbols_, symbol);
+  if (column == symbols_.end())
+    return;
+
+  const auto *bars = this->bars(symbol);
+  volumes_.load(static_cast<std::size_t>(column - symbols_.begin()),
+                bars ? std::span{*bars} : std::span<const Bar>{});
+}
+
+std::map<std::string, double, std::less<>>
+MarketDataCache::volume_ratios() const {
+  const auto ratios = volumes_.volume_ratio(volume_ratio_bars);
+  auto by_symbol = std::map<std::string, double, std::less<>>{};
+  for (auto i = 0uz; i < symbols_.size(); ++i)
+    by_symbol.emplace(symbols_[i], ratios[i]);
+  return by_symbol;
+}
+
+void MarketDataCache::rebuild_symbol(const std::string &symbol) {
+  load_volumes(symbol);
+
+  const auto *bars = this->bars(symbol);
+  if (not bars or bars->empty()) {
+    histories_.erase(symbol);
+    strategy_sets_.erase(symbol);
+    settled_.erase(symbol);
+    return;
+  }
+
+  auto history = PriceHistory{};
+  auto strategies = StrategySet{};
+  for (const auto &bar : std::span{*bars}.first(bars->size() - 1))
+    feed(history, strategies, bar);
+
+  settled_.insert_or_assign(symbol,
+                            SettledState{.history = history,
+                                         .strategies = strategies,
+                                         .last_bar = bars->back().timestamp});
+  feed(history, strategies, bars->back());
+
+  histories_.insert_or_assign(symbol, std::move(history));
+  strategy_sets_.insert_or_assign(symbol, std::move(strategies));
+}
+
+void MarketDataCache::update_symbol(const std::string &symbol,
+                                   std::int64_t changed_from) {
+  const auto *bars = this->bars(symbol);
+  auto settled = settled_.find(symbol);
+  auto history = histories_.find(symbol);
+  auto strategies = strategy_sets_.find(symbol);
+  if (not bars or settled == settled_.end() or
+      history == histories_.end() or strategies == strategy_sets_.end() or
+      changed_from < settled->second.last_bar) {
+    rebuild_symbol(symbol);
+    return;
+  }
+
+  load_volumes(symbol);
+
+  // The last bar applied was modified: start again from the state before it
+  auto &state = settled->second;
+  if (changed_from == state.last_bar) {
+    history->second = state.history;
+    strategies->second = state.strategies;
+  }
+
+  // Apply the changed bars, keeping the state before the last of them
+  const auto first =
+      std::ranges::lower_bound(*bars, changed_from, {}, &Bar::timestamp);
+  for (auto it = first; it != bars->end(); ++it) {
+    if (std::next(it) == bars->end()) {
+      state.history = history->second;
+      state.strategies = strategies->second;
+      state.last_bar = it->timestamp;
+    }
+    feed(history->second, strategies->second, *it);
+  }
+}
+
+void MarketDataCache::rebuild_histories() {
+  histories_.clear();
+  strategy_sets_.clear();
+  settled_.clear();
+  for (const auto &[symbol, bars] : bars_)
+    rebuild_symbol(symbol);
+}
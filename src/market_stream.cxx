@@ -0,0 +1,240 @@
+// Streaming market data ingestion
+// Reads Alpaca-format stream messages on a background thread and queues them
+// for the trading loop
+
+#include "market_stream.h"
+#include "market_data_cache.h"
+#include "timestamps.h"
+#include <cstdlib>
+#include <netdb.h>
+#include <nlohmann/json.hpp>
+#include <print>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string env_or(const char *name, std::string fallback) {
+  if (const auto *val = std::getenv(name))
+    return val;
+  return fallback;
+}
+
+// Sleep that returns early when the stream is shutting down
+void wait_or_stop(std::stop_token stop, std::chrono::milliseconds duration) {
+  using namespace std::chrono_literals;
+  for (auto waited = 0ms; waited < duration and not stop.stop_requested();
+       waited += 100ms)
+    std::this_thread::sleep_for(100ms);
+}
+
+// Don't raise SIGPIPE if the peer has gone away
+#ifdef MSG_NOSIGNAL
+constexpr auto send_flags = MSG_NOSIGNAL;
+#else
+constexpr auto send_flags = 0;
+#endif
+
+bool send_line(int fd, const std::string &line) {
+  const auto data = line + "\n";
+  auto sent = 0uz;
+  while (sent < data.size()) {
+    const auto n = ::send(fd, data.data() + sent, data.size() - sent, send_flags);
+    if (n <= 0)
+      return false;
+    sent += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+MarketStream::MarketStream(std::string_view address,
+                           std::vector<std::string> symbols)
+    : key_{env_or("ALPACA_DATA_API_KEY", env_or("ALPACA_API_KEY", ""))},
+      secret_{env_or("ALPACA_DATA_API_SECRET", env_or("ALPACA_API_SECRET", ""))},
+      symbols_{std::move(symbols)} {
+  // Address is "host:port"
+  const auto colon = address.rfind(':');
+  host_ = std::string{address.substr(0, colon)};
+  port_ = colon == std::string_view::npos ? "8765"
+                                          : std::string{address.substr(colon + 1)};
+
+  thread_ = std::jthread{[this](std::stop_token stop) { run(stop); }};
+}
+
+MarketStream::~MarketStream() {
+  thread_.request_stop();
+
+  // Unblock the reader thread's recv()
+  if (const auto fd = fd_.load(); fd >= 0)
+    ::shutdown(fd, SHUT_RDWR);
+}
+
+bool MarketStream::connect_and_subscribe() {
+  auto hints = addrinfo{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo *addresses = nullptr;
+  if (::getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addresses) != 0)
+    return false;
+
+  auto fd = -1;
+  for (auto *addr = addresses; addr != nullptr; addr = addr->ai_next) {
+    fd = ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (fd < 0)
+      continue;
+    if (::connect(fd, addr->ai_addr, addr->ai_addrlen) == 0)
+      break;
+    ::close(fd);
+    fd = -1;
+  }
+  ::freeaddrinfo(addresses);
+
+  if (fd < 0)
+    return false;
+
+  // Same requests as the Alpaca WebSocket API
+  const auto auth = json{{"action", "auth"}, {"key", key_}, {"secret", secret_}};
+  const auto subscribe = json{{"action", "subscribe"},
+                              {"bars", symbols_},
+                              {"quotes", symbols_},
+                              {"trades", symbols_}};
+
+  if (not send_line(fd, auth.dump()) or not send_line(fd, subscribe.dump())) {
+    ::close(fd);
+    return false;
+  }
+
+  fd_ = fd;
+  connected_ = true;
+  return true;
+}
+
+void MarketStream::run(std::stop_token stop) {
+  using namespace std::chrono_literals;
+
+  while (not stop.stop_requested()) {
+    if (not connect_and_subscribe()) {
+      std::println(stderr, "  ⚠️  Stream connect to {}:{} failed - retrying",
+                   host_, port_);
+      wait_or_stop(stop, 5s);
+      continue;
+    }
+
+    // Read newline-delimited messages until the connection drops
+    auto buffer = std::string{};
+    char chunk[4096];
+    while (not stop.stop_requested()) {
+      const auto n = ::recv(fd_, chunk, sizeof(chunk), 0);
+      if (n <= 0)
+        break;
+
+      buffer.append(chunk, static_cast<std::size_t>(n));
+      for (auto eol = buffer.find('\n'); eol != std::string::npos;
+           eol = buffer.find('\n')) {
+        handle_line(std::string_view{buffer}.substr(0, eol));
+        buffer.erase(0, eol + 1);
+      }
+    }
+
+    connected_ = false;
+    ::close(fd_.exchange(-1));
+
+    if (not stop.stop_requested()) {
+      std::println(stderr, "  ⚠️  Stream disconnected - reconnecting");
+      wait_or_stop(stop, 1s);
+    }
+  }
+}
+
+void MarketStream::handle_line(std::string_view line) {
+  auto messages = json::parse(line, nullptr, false);
+  if (messages.is_discarded())
+    return;
+
+  // Messages arrive as arrays; accept single objects too
+  if (not messages.is_array())
+    messages = json::array({messages});
+
+  auto events = std::vector<StreamEvent>{};
+  for (const auto &msg : messages) {
+    ++messages_;
+    const auto type = msg.value("T", "");
+
+    if (type == "error") {
+      std::println(stderr, "  ⚠️  Stream error: {}", msg.value("msg", ""));
+      continue;
+    }
+
+    if (type != "b" and type != "q" and type != "t")
+      continue; // success / subscription acknowledgements
+
+    auto event = StreamEvent{};
+    event.symbol = msg.value("S", "");
+    event.timestamp = parse_timestamp_ns(msg.value("t", ""));
+
+    if (type == "b") {
+      event.type = StreamEvent::Type::Bar;
+      event.bar = Bar{.timestamp = event.timestamp,
+                      .open = msg.value("o", 0.0),
+                      .high = msg.value("h", 0.0),
+                      .low = msg.value("l", 0.0),
+                      .close = msg.value("c", 0.0),
+                      .volume = msg.value("v", 0L)};
+    } else if (type == "q") {
+      event.type = StreamEvent::Type::Quote;
+      event.bid = msg.value("bp", 0.0);
+      event.ask = msg.value("ap", 0.0);
+    } else {
+      event.type = StreamEvent::Type::Trade;
+      event.price = msg.value("p", 0.0);
+    }
+
+    events.push_back(std::move(event));
+  }
+
+  if (events.empty())
+    return;
+
+  {
+    auto lock = std::lock_guard{mutex_};
+    pending_.insert(pending_.end(), std::make_move_iterator(events.begin()),
+                    std::make_move_iterator(events.end()));
+  }
+  cv_.notify_all();
+}
+
+bool MarketStream::wait_until(std::chrono::system_clock::time_point deadline) {
+  auto lock = std::unique_lock{mutex_};
+  return cv_.wait_until(lock, deadline, [this] { return not pending_.empty(); });
+}
+
+std::size_t MarketStream::drain(MarketDataCache &market_data) {
+  auto events = std::vector<StreamEvent>{};
+  {
+    auto lock = std::lock_guard{mutex_};
+    events.swap(pending_);
+  }
+
+  for (const auto &event : events) {
+    switch (event.type) {
+    case StreamEvent::Type::Bar:
+      market_data.apply_bar(event.symbol, event.bar);
+      break;
+    case StreamEvent::Type::Quote:
+      market_data.apply_quote(event.symbol, event.bid, event.ask,
+                              event.timestamp);
+      break;
+    case StreamEvent::Type::Trade:
+      market_data.apply_trade(event.symbol, event.price, event.timestamp);
+      break;
+    }
+  }
+
+  return events.size();
+}
@@ -0,0 +1,37 @@
+#include "position_book.h"
+#include <algorithm>
+
+void PositionBook::opened(const std::string &symbol, std::string_view strategy,
+                          time_point entered) {
+  auto lock = std::lock_guard{mutex_};
+  strategies_[symbol] = strategy;
+  entry_times_[symbol] = entered;
+}
+
+bool PositionBook::entered(std::string_view symbol) const {
+  auto lock = std::lock_guard{mutex_};
+  return strategies_.contains(symbol);
+}
+
+double PositionBook::update_peak(const std::string &symbol, double price) {
+  auto lock = std::lock_guard{mutex_};
+  const auto [it, inserted] = peaks_.try_emplace(symbol, price);
+  if (not inserted)
+    it->second = std::max(it->second, price);
+  return it->second;
+}
+
+bool PositionBook::begin_close(const std::string &symbol) {
+  auto lock = std::lock_guard{mutex_};
+  return closing_.insert(symbol).second;
+}
+
+void PositionBook::finish_close(const std::string &symbol, bool closed) {
+  auto lock = std::lock_guard{mutex_};
+  closing_.erase(symbol);
+  if (closed) {
+    strategies_.erase(symbol);
+    entry_times_.erase(symbol);
+    peaks_.erase(symbol);
+  }
+}
@@ -0,0 +1,69 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+// Burst allowance, in seconds of the current rate
+constexpr auto burst_seconds = 5.0;
+
+// Lowest rate a run of 429s can push us to, as a fraction of the quota
+constexpr auto min_rate_fraction = 1.0 / 8.0;
+
+// Rate won back per accepted request, as a fraction of the quota
+constexpr auto recovery_fraction = 1.0 / 50.0;
+} // namespace
+
+RateLimiter::RateLimiter(double requests_per_minute)
+    : quota_{requests_per_minute / 60.0}, rate_{quota_},
+      tokens_{rate_ * burst_seconds}, last_refill_{clock::now()} {}
+
+void RateLimiter::refill(clock::time_point now) {
+  if (now <= last_refill_)
+    return;
+  const auto elapsed = std::chrono::duration<double>(now - last_refill_);
+  tokens_ = std::min(std::max(rate_ * burst_seconds, 1.0),
+                     tokens_ + elapsed.count() * rate_);
+  last_refill_ = now;
+}
+
+bool RateLimiter::acquire() {
+  auto lock = std::unique_lock{mutex_};
+  refill(clock::now());
+
+  // Callers queue by reserving a token that doesn't exist yet and sleeping
+  // until it has been earned, so waiters are served in arrival order
+  tokens_ -= 1.0;
+  if (tokens_ >= 0.0 and last_refill_ <= clock::now())
+    return false;
+
+  const auto ready =
+      last_refill_ + std::chrono::duration_cast<clock::duration>(
+                         std::chrono::duration<double>(
+                             std::max(-tokens_, 0.0) / rate_));
+  lock.unlock();
+
+  std::this_thread::sleep_until(ready);
+  return true;
+}
+
+void RateLimiter::accepted(double quota_per_minute) {
+  auto lock = std::lock_guard{mutex_};
+  if (quota_per_minute > 0.0)
+    quota_ = quota_per_minute / 60.0;
+  rate_ = std::min(quota_, rate_ + quota_ * recovery_fraction);
+}
+
+void RateLimiter::rejected(clock::time_point resume) {
+  auto lock = std::lock_guard{mutex_};
+  refill(clock::now());
+
+  // Multiplicative decrease, and no tokens until the server's window resets
+  rate_ = std::max(quota_ * min_rate_fraction, rate_ / 2.0);
+  tokens_ = std::min(tokens_, 0.0);
+  last_refill_ = std::max(last_refill_, resume);
+}
+
+std::size_t RateLimiter::burst() const {
+  auto lock = std::lock_guard{mutex_};
+  return std::max(static_cast<std::size_t>(quota_ * burst_seconds), 1uz);
+}
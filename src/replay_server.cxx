@@ -0,0 +1,241 @@
+// Market data replay server
+// Serves cached bars (see BarStore) over the same newline-delimited stream
+// protocol MarketStream speaks, so streaming can be exercised offline
+// Each cached 15-minute bar is sent as the 1-minute bars the live feed would
+// have sent, which fold back into the original bar
+//
+// Usage: lft_replay [--port N] [--interval-ms N] [--live]
+//   --interval-ms  Delay between 1-minute bars (default 1000)
+//   --live         Stamp bars with consecutive minutes from the next whole
+//                  minute instead of their original time, so they land after
+//                  the bars lft already holds (they run ahead of the clock
+//                  unless --interval-ms is 60000)
+
+#include "bar_store.h"
+#include "bps_utils.h"
+#include "defs.h"
+#include "timestamps.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <nlohmann/json.hpp>
+#include <print>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr auto minutes_per_bar = 15uz; // Cached series are 15Min
+
+struct ReplayBar {
+  std::string symbol;
+  Bar bar;
+};
+
+// Don't raise SIGPIPE if the peer has gone away
+#ifdef MSG_NOSIGNAL
+constexpr auto send_flags = MSG_NOSIGNAL;
+#else
+constexpr auto send_flags = 0;
+#endif
+
+bool send_line(int fd, const std::string &line) {
+  const auto data = line + "\n";
+  auto sent = 0uz;
+  while (sent < data.size()) {
+    const auto n =
+        ::send(fd, data.data() + sent, data.size() - sent, send_flags);
+    if (n <= 0)
+      return false;
+    sent += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+// Wait for the client's auth and subscribe requests and acknowledge them
+bool handshake(int fd) {
+  auto buffer = std::string{};
+  auto subscribed = false;
+  char chunk[4096];
+
+  while (not subscribed) {
+    const auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0)
+      return false;
+
+    buffer.append(chunk, static_cast<std::size_t>(n));
+    for (auto eol = buffer.find('\n'); eol != std::string::npos;
+         eol = buffer.find('\n')) {
+      const auto request = json::parse(buffer.substr(0, eol), nullptr, false);
+      buffer.erase(0, eol + 1);
+
+      if (request.is_discarded())
+        continue;
+
+      const auto action = request.value("action", "");
+      if (action == "auth") {
+        send_line(fd, R"([{"T":"success","msg":"authenticated"}])");
+      } else if (action == "subscribe") {
+        auto ack = request;
+        ack.erase("action");
+        ack["T"] = "subscription";
+        send_line(fd, json::array({ack}).dump());
+        subscribed = true;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Split a cached 15-minute bar into the 1-minute bars the live feed sends
+// Folded back together (as MarketDataCache::apply_bar does) they give the
+// original bar: prices move linearly from open to close, the first minute
+// reaches the high and the second the low, and volume is spread evenly
+std::array<Bar, minutes_per_bar> split_bar(const Bar &bar) {
+  auto minutes = std::array<Bar, minutes_per_bar>{};
+  auto open = bar.open;
+  for (auto k = 0uz; k < minutes_per_bar; ++k) {
+    const auto close =
+        k + 1 == minutes_per_bar
+            ? bar.close
+            : bar.open + (bar.close - bar.open) * static_cast<double>(k + 1) /
+                             static_cast<double>(minutes_per_bar);
+    const auto spread = static_cast<long>(minutes_per_bar);
+    const auto index = static_cast<long>(k);
+    minutes[k] = Bar{
+        .timestamp = bar.timestamp + index * ns_per_minute,
+        .open = open,
+        .high = std::max(open, close),
+        .low = std::min(open, close),
+        .close = close,
+        .volume = bar.volume / spread + (index < bar.volume % spread ? 1 : 0),
+    };
+    open = close;
+  }
+  minutes[0].high = bar.high;
+  minutes[1].low = bar.low;
+  return minutes;
+}
+
+void replay(int fd, const std::vector<ReplayBar> &bars,
+            std::chrono::milliseconds interval, bool live) {
+  using namespace std::chrono;
+
+  // Live stamps are consecutive minutes from the next whole minute
+  const auto live_start_ns =
+      duration_cast<nanoseconds>(
+          (floor<minutes>(system_clock::now()) + 1min).time_since_epoch())
+          .count();
+  auto sent_minutes = std::int64_t{};
+
+  for (auto i = 0uz; i < bars.size();) {
+    // Every bar sharing this timestamp, split into minutes
+    const auto timestamp = bars[i].bar.timestamp;
+    auto group = std::vector<std::pair<const std::string *,
+                                       std::array<Bar, minutes_per_bar>>>{};
+    for (; i < bars.size() and bars[i].bar.timestamp == timestamp; ++i)
+      group.emplace_back(&bars[i].symbol, split_bar(bars[i].bar));
+
+    // One message batch per minute
+    for (auto k = 0uz; k < minutes_per_bar; ++k, ++sent_minutes) {
+      auto batch = json::array();
+      for (const auto &[symbol, minutes] : group) {
+        const auto &bar = minutes[k];
+        const auto stamp = format_timestamp(
+            live ? live_start_ns + sent_minutes * ns_per_minute
+                 : bar.timestamp);
+
+        // Synthetic 1 bp quote and a trade at the close for each bar
+        batch.push_back({{"T", "b"}, {"S", *symbol}, {"t", stamp},
+                         {"o", bar.open}, {"h", bar.high}, {"l", bar.low},
+                         {"c", bar.close}, {"v", bar.volume}});
+        batch.push_back({{"T", "q"}, {"S", *symbol}, {"t", stamp},
+                         {"bp", bar.close * (1.0 - 0.5_bps)},
+                         {"ap", bar.close * (1.0 + 0.5_bps)}});
+        batch.push_back(
+            {{"T", "t"}, {"S", *symbol}, {"t", stamp}, {"p", bar.close}});
+      }
+
+      if (not send_line(fd, batch.dump()))
+        return;
+
+      std::this_thread::sleep_for(interval);
+    }
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  auto port = 8765;
+  auto interval = std::chrono::milliseconds{1000};
+  auto live = false;
+
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--port" and i + 1 < argc)
+      port = std::atoi(argv[++i]);
+    else if (arg == "--interval-ms" and i + 1 < argc)
+      interval = std::chrono::milliseconds{std::atoi(argv[++i])};
+    else if (arg == "--live")
+      live = true;
+  }
+
+  // Load the watchlist from the bar cache and interleave by timestamp
+  const auto store = BarStore{bar_cache_dir};
+  auto bars = std::vector<ReplayBar>{};
+  for (const auto &symbol : stocks)
+    for (auto &bar : store.load(symbol, "15Min"))
+      bars.push_back({symbol, bar});
+
+  std::ranges::stable_sort(bars, {},
+                           [](const auto &b) { return b.bar.timestamp; });
+
+  if (bars.empty()) {
+    std::println("❌ No cached bars in {} - run lft once to populate it",
+                 bar_cache_dir);
+    return 1;
+  }
+
+  const auto server = ::socket(AF_INET, SOCK_STREAM, 0);
+  const auto reuse = 1;
+  ::setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  auto addr = sockaddr_in{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(static_cast<std::uint16_t>(port));
+
+  if (::bind(server, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 or
+      ::listen(server, 1) != 0) {
+    std::println("❌ Cannot listen on 127.0.0.1:{}", port);
+    return 1;
+  }
+
+  std::println("📡 Replaying {} bars as 1-minute bars on 127.0.0.1:{} every "
+               "{} ms",
+               bars.size(), port, interval.count());
+
+  // Serve one client at a time, restarting the replay for each
+  for (;;) {
+    const auto client = ::accept(server, nullptr, nullptr);
+    if (client < 0)
+      continue;
+
+    std::println("  Client connected");
+    if (handshake(client))
+      replay(client, bars, interval, live);
+
+    ::close(client);
+    std::println("  Client disconnected");
+  }
+}
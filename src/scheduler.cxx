@@ -0,0 +1,46 @@
+#include "scheduler.h"
+#include <algorithm>
+
+void Scheduler::add(std::string name, clock::time_point first, Task task) {
+  auto &lateness = latency_histogram("sched." + name);
+  tasks_.push_back({std::move(name), std::move(task), first, &lateness});
+  if (first != never())
+    queue_.push({first, tasks_.size() - 1});
+}
+
+Scheduler::clock::time_point Scheduler::next_deadline() const {
+  return queue_.empty() ? never() : queue_.top().deadline;
+}
+
+std::size_t Scheduler::run_due(clock::time_point now) {
+  // Take everything due first, so a task that comes straight back due isn't
+  // run twice in one pass
+  auto due = std::vector<Entry>{};
+  while (not queue_.empty() and queue_.top().deadline <= now) {
+    due.push_back(queue_.top());
+    queue_.pop();
+  }
+
+  for (const auto &entry : due) {
+    auto &task = tasks_[entry.task];
+    const auto start = clock::now();
+    task.lateness->record(start - entry.deadline);
+
+    task.deadline = task.run(start);
+    if (task.deadline != never())
+      queue_.push({task.deadline, entry.task});
+  }
+
+  return due.size();
+}
+
+std::vector<std::pair<std::string, Scheduler::clock::time_point>>
+Scheduler::upcoming(clock::time_point now) const {
+  auto pending = std::vector<std::pair<std::string, clock::time_point>>{};
+  for (const auto &task : tasks_)
+    if (task.deadline > now and task.deadline != never())
+      pending.emplace_back(task.name, task.deadline);
+
+  std::ranges::stable_sort(pending, {}, [](const auto &p) { return p.second; });
+  return pending;
+}
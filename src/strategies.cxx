@@ -1,38 +1,52 @@
 #include "strategies.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <format>
 
-namespace {
-    constexpr auto max_history_size = 100uz;
-}
-
 // PriceHistory implementation
 
-void PriceHistory::add_price_with_timestamp(double price, std::string_view timestamp) {
+void PriceHistory::add_price_with_timestamp(double price, std::int64_t timestamp) {
     // Only add if this is a NEW trade (different timestamp)
-    if (timestamp.empty() or timestamp != last_trade_timestamp) {
-        prices.push_back(price);
-        last_trade_timestamp = std::string{timestamp};
-
-        // Keep last max_history_size data points for moving averages
-        if (prices.size() > max_history_size)
-            prices.pop_front();
-
-        if (prices.size() >= 2uz) {
-            last_price = prices[prices.size() - 2uz];
-            change_percent = ((price - last_price) / last_price) * 100.0;
-            has_history = true;
-        }
+    if (timestamp == 0 or timestamp != last_trade_timestamp) {
+        last_trade_timestamp = timestamp;
+        add_price(price);
     }
     // If same timestamp: do nothing, preserve existing change_percent
 }
 
 void PriceHistory::add_price(double price) {
+    push_price(price);
+
+    if (++updates_since_rebuild == max_history_size)
+        rebuild_indicators();
+}
+
+void PriceHistory::push_price(double price) {
+    // Update windowed indicators with the incoming price and the one leaving
+    // each window, before the buffer evicts it
+    const auto held = prices.size();
+
+    if (held >= ma_short_periods)
+        ma_short_sum.slide(price, prices[held - ma_short_periods]);
+    else
+        ma_short_sum.push(price);
+
+    if (held >= ma_long_periods)
+        price_stats.slide(price, prices[held - ma_long_periods]);
+    else
+        price_stats.push(price);
+
+    if (held >= 1uz) {
+        const auto ret = (price - prices.back()) / prices.back();
+        if (held == prices.capacity())
+            return_stats.slide(ret, (prices[1] - prices[0]) / prices[0]);
+        else
+            return_stats.push(ret);
+    }
+
+    // Keeps last max_history_size data points for moving averages
     prices.push_back(price);
-    // Keep last max_history_size data points for moving averages
-    if (prices.size() > max_history_size)
-        prices.pop_front();
 
     if (prices.size() >= 2uz) {
         last_price = prices[prices.size() - 2uz];
@@ -42,27 +56,68 @@ void PriceHistory::add_price(double price) {
 }
 
 void PriceHistory::add_bar(double close, double high, double low, long volume) {
-    add_price(close);
+    // Bar leaving the noise window (aligned by recency across the buffers)
+    const auto noise = (high - low) / close;
+    if (highs.size() >= noise_periods and prices.size() >= noise_periods) {
+        const auto oldest = highs.size() - noise_periods;
+        noise_sum.slide(noise, (highs[oldest] - lows[oldest]) /
+                                   prices[prices.size() - noise_periods]);
+    } else {
+        noise_sum.push(noise);
+    }
+
+    if (volumes.size() == volumes.capacity())
+        volume_sum.slide(volume, volumes.front());
+    else
+        volume_sum.push(volume);
+
+    push_price(close);
+    // Same capacity as prices, so the buffers stay in step
     highs.push_back(high);
     lows.push_back(low);
     volumes.push_back(volume);
 
-    // Keep synced with prices
-    if (highs.size() > max_history_size)
-        highs.pop_front();
-    if (lows.size() > max_history_size)
-        lows.pop_front();
-    if (volumes.size() > max_history_size)
-        volumes.pop_front();
+    if (++updates_since_rebuild == max_history_size)
+        rebuild_indicators();
+}
+
+void PriceHistory::rebuild_indicators() {
+    updates_since_rebuild = 0uz;
+
+    ma_short_sum.reset();
+    for (auto price : prices.last(std::min(prices.size(), ma_short_periods)))
+        ma_short_sum.push(price);
+
+    price_stats.reset();
+    for (auto price : prices.last(std::min(prices.size(), ma_long_periods)))
+        price_stats.push(price);
+
+    return_stats.reset();
+    for (auto i = 1uz; i < prices.size(); ++i)
+        return_stats.push((prices[i] - prices[i-1uz]) / prices[i-1uz]);
+
+    // Volume sums are exact integers and never need rebuilding
+    const auto bars = std::min({highs.size(), lows.size(), prices.size(), noise_periods});
+    noise_sum.reset();
+    for (auto i = 0uz; i < bars; ++i) {
+        const auto h = highs.size() - bars + i;
+        const auto p = prices.size() - bars + i;
+        noise_sum.push((highs[h] - lows[h]) / prices[p]);
+    }
 }
 
 double PriceHistory::moving_average(size_t periods) const {
     if (prices.size() < periods)
         return 0.0;
 
+    if (periods == ma_short_periods)
+        return ma_short_sum.sum() / periods;
+    if (periods == ma_long_periods)
+        return price_stats.mean();
+
     auto sum = 0.0;
-    for (auto i = prices.size() - periods; i < prices.size(); ++i)
-        sum += prices[i];
+    for (auto price : prices.last(periods))
+        sum += price;
 
     return sum / periods;
 }
@@ -71,46 +126,30 @@ double PriceHistory::volatility() const {
     if (prices.size() < 2uz)
         return 0.0;
 
-    // Calculate returns (percentage changes between consecutive prices)
-    auto returns = std::vector<double>{};
-    returns.reserve(prices.size() - 1uz);
-
-    for (auto i = 1uz; i < prices.size(); ++i) {
-        auto ret = (prices[i] - prices[i-1uz]) / prices[i-1uz];
-        returns.push_back(ret);
-    }
-
-    // Calculate mean return
-    auto sum = 0.0;
-    for (const auto& ret : returns)
-        sum += ret;
-    auto mean_return = sum / returns.size();
-
-    // Calculate variance of returns
-    auto variance = 0.0;
-    for (const auto& ret : returns) {
-        auto diff = ret - mean_return;
-        variance += diff * diff;
-    }
-
-    // Return standard deviation of returns (volatility)
-    return std::sqrt(variance / returns.size());
+    // Standard deviation of returns (percentage changes between consecutive
+    // prices) across the whole history
+    return std::sqrt(return_stats.variance());
 }
 
 double PriceHistory::price_std_dev(size_t periods) const {
     if (prices.size() < periods)
         return 0.0;
 
+    if (periods == ma_long_periods)
+        return std::sqrt(price_stats.variance());
+
+    const auto window = prices.last(periods);
+
     // Calculate mean of price series
     auto sum = 0.0;
-    for (auto i = prices.size() - periods; i < prices.size(); ++i)
-        sum += prices[i];
+    for (auto price : window)
+        sum += price;
     auto mean_price = sum / periods;
 
     // Calculate variance of prices
     auto variance = 0.0;
-    for (auto i = prices.size() - periods; i < prices.size(); ++i) {
-        auto diff = prices[i] - mean_price;
+    for (auto price : window) {
+        auto diff = price - mean_price;
         variance += diff * diff;
     }
 
@@ -122,11 +161,18 @@ double PriceHistory::recent_noise(size_t periods) const {
     if (highs.size() < periods or lows.size() < periods or prices.size() < periods)
         return 0.0;
 
-    auto total_noise = 0.0;
-    auto start_idx = prices.size() - periods;
+    // Running sum is valid while bars arrive through add_bar
+    if (periods == noise_periods and noise_sum.count() == noise_periods and
+        highs.size() == prices.size())
+        return noise_sum.sum() / periods;
+
+    const auto recent_highs = highs.last(periods);
+    const auto recent_lows = lows.last(periods);
+    const auto recent_prices = prices.last(periods);
 
-    for (auto i = start_idx; i < prices.size(); ++i) {
-        auto noise = (highs[i] - lows[i]) / prices[i];
+    auto total_noise = 0.0;
+    for (auto i = 0uz; i < periods; ++i) {
+        auto noise = (recent_highs[i] - recent_lows[i]) / recent_prices[i];
         total_noise += noise;
     }
 
@@ -137,11 +183,7 @@ long PriceHistory::avg_volume() const {
     if (volumes.empty())
         return 0;
 
-    auto sum = 0L;
-    for (auto vol : volumes)
-        sum += vol;
-
-    return sum / static_cast<long>(volumes.size());
+    return volume_sum.sum() / static_cast<long>(volumes.size());
 }
 
 double PriceHistory::volume_factor() const {
@@ -188,48 +230,6 @@ StrategySignal Strategies::evaluate_dip(const PriceHistory& history, double thre
     return signal;
 }
 
-StrategySignal Strategies::evaluate_ma_crossover(const PriceHistory& history) {
-    auto signal = StrategySignal{};
-    signal.strategy_name = "ma_crossover";
-
-    // Need at least 20 data points for short MA
-    if (history.prices.size() < 20uz)
-        return signal;
-
-    auto ma_short = history.moving_average(5);   // 5-period MA
-    auto ma_long = history.moving_average(20);   // 20-period MA
-
-    // Defensive assertions: MAs should be valid
-    assert(std::isfinite(ma_short) && ma_short > 0.0 && "Short MA must be positive and finite");
-    assert(std::isfinite(ma_long) && ma_long > 0.0 && "Long MA must be positive and finite");
-
-    // Previous values to detect crossover
-    if (history.prices.size() < 21uz)
-        return signal;
-
-    auto prev_prices = history.prices;
-    prev_prices.pop_back();
-
-    auto prev_ma_short = 0.0;
-    auto prev_ma_long = 0.0;
-
-    for (auto i = prev_prices.size() - 5uz; i < prev_prices.size(); ++i)
-        prev_ma_short += prev_prices[i];
-    prev_ma_short /= 5.0;
-
-    for (auto i = prev_prices.size() - 20uz; i < prev_prices.size(); ++i)
-        prev_ma_long += prev_prices[i];
-    prev_ma_long /= 20.0;
-
-    // Bullish crossover: short MA crosses above long MA
-    if (prev_ma_short <= prev_ma_long and ma_short > ma_long) {
-        signal.should_buy = true;
-        signal.reason = std::format("MA crossover: {:.2f} > {:.2f}", ma_short, ma_long);
-    }
-
-    return signal;
-}
-
 StrategySignal Strategies::evaluate_mean_reversion(const PriceHistory& history) {
     auto signal = StrategySignal{};
     signal.strategy_name = "mean_reversion";
@@ -261,50 +261,41 @@ StrategySignal Strategies::evaluate_mean_reversion(const PriceHistory& history)
     return signal;
 }
 
-StrategySignal Strategies::evaluate_volatility_breakout(const PriceHistory& history) {
-    auto signal = StrategySignal{};
-    signal.strategy_name = "volatility_breakout";
+StrategySignal Strategies::evaluate_relative_strength(
+    const PriceHistory& history,
+    const std::map<std::string, PriceHistory>& all_histories) {
 
-    if (history.prices.size() < 20uz)
+    if (not history.has_history) {
+        auto signal = StrategySignal{};
+        signal.strategy_name = "relative_strength";
         return signal;
-
-    // Calculate recent volatility vs historical
-    auto recent_volatility = 0.0;
-    for (auto i = history.prices.size() - 5uz; i < history.prices.size() - 1uz; ++i) {
-        auto change = std::abs((history.prices[i + 1] - history.prices[i]) / history.prices[i]);
-        assert(std::isfinite(change) && "Price change must be finite");
-        recent_volatility += change;
     }
-    recent_volatility /= 4.0;
 
-    auto historical_volatility = history.volatility();
-
-    // Defensive assertions: validate volatility calculations
-    assert(std::isfinite(recent_volatility) && recent_volatility >= 0.0 && "Recent volatility must be non-negative and finite");
-    assert(std::isfinite(historical_volatility) && historical_volatility >= 0.0 && "Historical volatility must be non-negative and finite");
-
-    // Buy when volatility expands (breakout from compression)
-    if (historical_volatility > 0 and recent_volatility > historical_volatility * 1.5 and history.change_percent > 0) {
-        signal.should_buy = true;
-        signal.reason = std::format("Volatility breakout: {:.4f} vs {:.4f}", recent_volatility, historical_volatility);
-    }
-
-    return signal;
+    return evaluate_relative_strength(history, market_average_change(all_histories));
 }
 
 StrategySignal Strategies::evaluate_relative_strength(
-    const PriceHistory& history,
-    const std::map<std::string, PriceHistory>& all_histories) {
+    const PriceHistory& history, std::optional<double> market_average) {
 
     auto signal = StrategySignal{};
     signal.strategy_name = "relative_strength";
 
-    if (not history.has_history)
+    // No assets to compare against (can be empty if network failed during initial fetch)
+    if (not history.has_history or not market_average)
         return signal;
 
-    // Need at least one asset to compare against (can be empty if network failed during initial fetch)
-    if (all_histories.empty())
-        return signal;
+    // Buy if this asset is outperforming market by >0.5%
+    if (history.change_percent > *market_average + 0.5) {
+        signal.should_buy = true;
+        signal.reason = std::format("Relative strength: {:.2f}% vs market {:.2f}%",
+                                    history.change_percent, *market_average);
+    }
+
+    return signal;
+}
+
+std::optional<double> Strategies::market_average_change(
+    const std::map<std::string, PriceHistory>& all_histories) {
 
     // Calculate average change across all assets
     auto total_change = 0.0;
@@ -319,19 +310,12 @@ StrategySignal Strategies::evaluate_relative_strength(
     }
 
     if (count == 0uz)
-        return signal;
+        return std::nullopt;
 
     auto market_average = total_change / count;
     assert(std::isfinite(market_average) && "Market average must be finite");
 
-    // Buy if this asset is outperforming market by >0.5%
-    if (history.change_percent > market_average + 0.5) {
-        signal.should_buy = true;
-        signal.reason = std::format("Relative strength: {:.2f}% vs market {:.2f}%",
-                                    history.change_percent, market_average);
-    }
-
-    return signal;
+    return market_average;
 }
 
 StrategySignal Strategies::evaluate_volume_surge(const PriceHistory& history) {
@@ -392,3 +376,90 @@ double Strategies::calculate_volume_ratio(const PriceHistory& history) {
     auto current_vol = static_cast<double>(history.volumes.back());
     return current_vol / avg;
 }
+
+// Stateful strategy implementations
+
+void MaCrossoverStrategy::on_bar(const PriceHistory& history) {
+    prev_ma_short_ = ma_short_;
+    prev_ma_long_ = ma_long_;
+    has_prev_ma_ = has_ma_;
+
+    // Need at least ma_long_periods data points for both MAs
+    has_ma_ = history.prices.size() >= ma_long_periods;
+    ma_short_ = history.moving_average(ma_short_periods);
+    ma_long_ = history.moving_average(ma_long_periods);
+}
+
+StrategySignal MaCrossoverStrategy::signal(const PriceHistory&, const MarketContext&) const {
+    auto signal = StrategySignal{};
+    signal.strategy_name = name;
+
+    // Previous bar's MAs are needed to detect the crossover
+    if (not has_ma_ or not has_prev_ma_)
+        return signal;
+
+    // Defensive assertions: MAs should be valid
+    assert(std::isfinite(ma_short_) && ma_short_ > 0.0 && "Short MA must be positive and finite");
+    assert(std::isfinite(ma_long_) && ma_long_ > 0.0 && "Long MA must be positive and finite");
+
+    // Bullish crossover: short MA crosses above long MA
+    if (prev_ma_short_ <= prev_ma_long_ and ma_short_ > ma_long_) {
+        signal.should_buy = true;
+        signal.reason = std::format("MA crossover: {:.2f} > {:.2f}", ma_short_, ma_long_);
+    }
+
+    return signal;
+}
+
+StrategySignal MeanReversionStrategy::signal(const PriceHistory& history, const MarketContext&) const {
+    return Strategies::evaluate_mean_reversion(history);
+}
+
+void VolatilityBreakoutStrategy::on_bar(const PriceHistory& history) {
+    const auto& prices = history.prices;
+    if (prices.size() < 2uz)
+        return;
+
+    const auto previous = prices[prices.size() - 2uz];
+    recent_changes_.push_back(std::abs((prices.back() - previous) / previous));
+}
+
+StrategySignal VolatilityBreakoutStrategy::signal(const PriceHistory& history, const MarketContext&) const {
+    auto signal = StrategySignal{};
+    signal.strategy_name = name;
+
+    if (history.prices.size() < 20uz)
+        return signal;
+
+    assert(recent_changes_.size() == recent_changes_.capacity() && "on_bar must see every bar");
+
+    // Recent volatility (last 4 bars) vs historical
+    auto recent_volatility = 0.0;
+    for (auto change : recent_changes_) {
+        assert(std::isfinite(change) && "Price change must be finite");
+        recent_volatility += change;
+    }
+    recent_volatility /= 4.0;
+
+    auto historical_volatility = history.volatility();
+
+    // Defensive assertions: validate volatility calculations
+    assert(std::isfinite(recent_volatility) && recent_volatility >= 0.0 && "Recent volatility must be non-negative and finite");
+    assert(std::isfinite(historical_volatility) && historical_volatility >= 0.0 && "Historical volatility must be non-negative and finite");
+
+    // Buy when volatility expands (breakout from compression)
+    if (historical_volatility > 0 and recent_volatility > historical_volatility * 1.5 and history.change_percent > 0) {
+        signal.should_buy = true;
+        signal.reason = std::format("Volatility breakout: {:.4f} vs {:.4f}", recent_volatility, historical_volatility);
+    }
+
+    return signal;
+}
+
+StrategySignal RelativeStrengthStrategy::signal(const PriceHistory& history, const MarketContext& market) const {
+    return Strategies::evaluate_relative_strength(history, market.average_change);
+}
+
+StrategySignal VolumeSurgeStrategy::signal(const PriceHistory& history, const MarketContext&) const {
+    return Strategies::evaluate_volume_surge(history);
+}
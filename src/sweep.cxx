@@ -0,0 +1,124 @@
+// Exit-parameter sweep
+// Backtests a grid of exit thresholds over the calibration bars and ranks
+// them by the P&L calibration would have enabled
+
+#include "backtest.h"
+#include "defs.h"
+#include "lft.h"
+#include "strategies.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <map>
+#include <print>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Candidate thresholds; every combination is tested
+constexpr auto take_profit_grid = std::array{0.02, 0.03, 0.05, 0.10};
+constexpr auto stop_loss_grid = std::array{0.01, 0.02, 0.03};
+constexpr auto trailing_stop_grid = std::array{0.005, 0.009, 0.018, 0.027};
+constexpr auto panic_stop_grid = std::array{0.035, 0.06};
+
+// Grid combinations plus the live thresholds from defs.h (if not already
+// on the grid), skipping any whose panic stop would never fire first
+std::vector<ExitParams> exit_param_grid() {
+  auto grid = std::vector<ExitParams>{ExitParams{}};
+  for (const auto tp : take_profit_grid)
+    for (const auto sl : stop_loss_grid)
+      for (const auto ts : trailing_stop_grid)
+        for (const auto panic : panic_stop_grid) {
+          if (panic <= sl)
+            continue;
+          if (tp == take_profit_pct and sl == stop_loss_pct and
+              ts == trailing_stop_pct and panic == panic_stop_loss_pct)
+            continue;
+          grid.push_back(ExitParams{.take_profit_pct = tp,
+                                    .stop_loss_pct = sl,
+                                    .trailing_stop_pct = ts,
+                                    .panic_stop_loss_pct = panic});
+        }
+  return grid;
+}
+
+// One grid row, scored the way calibration would trade it
+struct SweepRow {
+  const ExitParams *exit;
+  StrategyMask enabled;
+  double enabled_profit{}; // Net P&L of the enabled strategies
+  uint32_t trades{};       // Trades closed by the enabled strategies
+  uint32_t wins{};
+};
+
+SweepRow score(const ExitParams &exit, const BacktestResult &result) {
+  auto row = SweepRow{.exit = &exit, .enabled = {}};
+  for (auto id = 0uz; id < strategy_count; ++id) {
+    const auto &stats = result[id];
+    // Same rule as calibrate()
+    if (stats.net_profit() <= 0.0 or stats.trades_closed < min_trades_to_enable)
+      continue;
+    row.enabled.set(id);
+    row.enabled_profit += stats.net_profit();
+    row.trades += stats.trades_closed;
+    row.wins += stats.profitable_trades;
+  }
+  return row;
+}
+
+bool is_live(const ExitParams &exit) {
+  return exit.take_profit_pct == take_profit_pct and
+         exit.stop_loss_pct == stop_loss_pct and
+         exit.trailing_stop_pct == trailing_stop_pct and
+         exit.panic_stop_loss_pct == panic_stop_loss_pct;
+}
+
+} // anonymous namespace
+
+void sweep_exit_params(const std::map<std::string, std::vector<Bar>> &all_bars,
+                       double starting_capital, std::size_t threads) {
+  const auto grid = exit_param_grid();
+  auto pool = ThreadPool{threads};
+
+  std::println("\n  🔧 Sweeping {} exit configurations x {} strategies on {} threads...",
+               grid.size(), strategy_count, pool.size());
+
+  const auto started = std::chrono::steady_clock::now();
+  const auto results = run_backtest(StrategyMask::all(), grid, all_bars,
+                                    starting_capital, pool);
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - started);
+
+  auto rows = std::vector<SweepRow>{};
+  rows.reserve(grid.size());
+  for (auto i = 0uz; i < grid.size(); ++i)
+    rows.push_back(score(grid[i], results[i]));
+
+  // Best enabled P&L first; ties keep grid order
+  std::ranges::stable_sort(rows, std::ranges::greater{},
+                           &SweepRow::enabled_profit);
+
+  std::println("\n📊 Exit sweep complete in {} ms (ranked by enabled P&L):\n",
+               elapsed.count());
+  std::println("  {:>4} {:>6} {:>6} {:>6} {:>6} {:>8} {:>7} {:>6} {:>11}",
+               "Rank", "TP%", "SL%", "Trail%", "Panic%", "Enabled", "Trades",
+               "WR%", "P&L");
+
+  for (auto rank = 1uz; const auto &row : rows) {
+    const auto win_rate =
+        row.trades > 0 ? 100.0 * row.wins / row.trades : 0.0;
+    std::println("  {:>4} {:>6.1f} {:>6.1f} {:>6.1f} {:>6.1f} {:>8} {:>7} "
+                 "{:>6.1f} {:>11.2f}{}",
+                 rank++, row.exit->take_profit_pct * 100.0,
+                 row.exit->stop_loss_pct * 100.0,
+                 row.exit->trailing_stop_pct * 100.0,
+                 row.exit->panic_stop_loss_pct * 100.0,
+                 std::format("{}/{}", row.enabled.count(), strategy_count),
+                 row.trades, win_rate, row.enabled_profit,
+                 is_live(*row.exit) ? "  ◀ live (defs.h)" : "");
+  }
+  std::println("");
+}
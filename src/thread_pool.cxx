@@ -0,0 +1,29 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  workers_.reserve(threads);
+  for (auto i = 0uz; i < threads; ++i)
+    workers_.emplace_back([this](std::stop_token stop) { run(stop); });
+}
+
+void ThreadPool::run(std::stop_token stop) {
+  while (true) {
+    auto task = std::move_only_function<void()>{};
+    {
+      auto lock = std::unique_lock{mutex_};
+
+      // Drain the queue before honouring a stop request
+      if (not cv_.wait(lock, stop, [this] { return not queue_.empty(); }))
+        return;
+
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    task();
+  }
+}
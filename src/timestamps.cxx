@@ -0,0 +1,22 @@
+#include "timestamps.h"
+#include <format>
+
+std::string format_timestamp(std::int64_t ns) {
+  using namespace std::chrono;
+
+  const auto time = sys_time<nanoseconds>{nanoseconds{ns}};
+  const auto day = floor<days>(time);
+  const auto date = year_month_day{day};
+  const auto tod = hh_mm_ss{floor<seconds>(time) - day};
+  const auto fraction = (time - floor<seconds>(time)).count();
+
+  auto text = std::format("{:04}-{:02}-{:02}T{:02}:{:02}:{:02}",
+                          static_cast<int>(date.year()),
+                          static_cast<unsigned>(date.month()),
+                          static_cast<unsigned>(date.day()), tod.hours().count(),
+                          tod.minutes().count(), tod.seconds().count());
+  if (fraction != 0)
+    text += std::format(".{:09}", fraction);
+
+  return text + "Z";
+}